@@ -4,12 +4,14 @@
 
 #include "include/BVHTree.h"
 #include <algorithm>
+#include <limits>
 
 using namespace std;
 
 BVHTree::BVHTree(const std::vector<Surface *> *surfaces) {
     this->root = nullptr;
     this->surfaces = surfaces;
+    this->nodes_visited = 0;
 }
 
 BVHTree::~BVHTree() {
@@ -21,10 +23,11 @@ BVHTree::~BVHTree() {
  * @brief   Given a list of surfaces it creates a Bounding Volume
  *          Hierarchical Tree structure.
  *
+ * @param verbose - whether to report the construction time.
  * @returns  a BVHTree for the corresponding list of surfaces.
  * @see      _makeBVHTree function
  */
-int BVHTree::makeBVHTree() {
+int BVHTree::makeBVHTree(bool verbose) {
     vector<BoundingBox *> bboxes;
     clock_t time;
 
@@ -38,12 +41,16 @@ int BVHTree::makeBVHTree() {
         bboxes.push_back(bbox);
     }
 
-    cout << "Constructing BVH Tree. ";
+    if (verbose)
+        cout << "Constructing BVH Tree. ";
+
     time = clock();
     this->root = this->_makeBVHTree(bboxes, 0, (int) (bboxes.size() - 1), 0);
     time = clock() - time;
-    cout << "[Done] [" << ((float) time) / CLOCKS_PER_SEC << "s]"
-         << endl << endl;
+
+    if (verbose)
+        cout << "[Done] [" << ((float) time) / CLOCKS_PER_SEC << "s]"
+             << endl << endl;
 
     return (this->root != nullptr);
 
@@ -122,8 +129,9 @@ BVHNode *BVHTree::_makeBVHTree(vector<BoundingBox *> &bboxes,
  * @name    isIntercepted
  * @see     _isIntercepted
  */
-bool BVHTree::isIntercepted(const Ray &ray, float t_max, int mode) const {
-    return this->_isIntercepted(this->root, ray, t_max, mode);
+template <int MODE>
+bool BVHTree::isIntercepted(const Ray &ray, float t_max) const {
+    return this->_isIntercepted<MODE>(this->root, ray, t_max);
 }
 
 /**
@@ -138,15 +146,16 @@ bool BVHTree::isIntercepted(const Ray &ray, float t_max, int mode) const {
  * @param t_max - the destination of the ray; the ray should be intercepted
  *                before reaching this point; represented in terms of the
  *                parameter on the ray.
- * @param mode  - 0|-1 => check interception with leaf node surfaces.
+ * @tparam MODE - 0|-1 => check interception with leaf node surfaces.
  *                1    => check interception with leaf node bounding box.
  *
  *
  * @returns a boolean indicating if the ray was intercepted by any surface on
  *          it's way to the destination.
  */
+template <int MODE>
 bool BVHTree::_isIntercepted(const BVHNode *node,
-                             const Ray &ray, float t_max, int mode) const {
+                             const Ray &ray, float t_max) const {
     if (node == nullptr)
         return false;
 
@@ -165,12 +174,10 @@ bool BVHTree::_isIntercepted(const BVHNode *node,
     if (node->left == nullptr && node->right == nullptr) {
         int surface_idx = node->thisBound->getBoundedSurface();
 
-        if (mode == 1 && t_bbox < t_max - 0.05f)
+        if (MODE == 1 && t_bbox < t_max - 0.05f)
             return true;
 
-        float t = this->at(surface_idx)->getIntersection(ray);
-
-        return (t >= 0 && t < t_max - 0.05f);
+        return this->at(surface_idx)->intercepts(ray, t_max);
     }
 
     /*
@@ -178,34 +185,160 @@ bool BVHTree::_isIntercepted(const BVHNode *node,
      * traverse the left and right nodes to find intersections. If either one
      * of the node returns an interception return true.
      */
-    return _isIntercepted(node->left, ray, t_max, mode) ||
-           _isIntercepted(node->right, ray, t_max, mode);
+    return _isIntercepted<MODE>(node->left, ray, t_max) ||
+           _isIntercepted<MODE>(node->right, ray, t_max);
+}
+
+/**
+ * @name    getOcclusionMask
+ * @see     _getOcclusionMask
+ */
+unsigned int BVHTree::getOcclusionMask(const RayPacket &packet) const {
+    unsigned int occluded = 0;
+
+    _getOcclusionMask(this->root, packet, packet.activeMask(), occluded);
+    return occluded;
+}
+
+/**
+ * @name    _getOcclusionMask
+ * @private used internally by BVHTree class (called by getOcclusionMask)
+ * @brief   Determines which rays of a packet are intercepted by a surface
+ *          before they reach their destination.
+ *
+ * @param node     - the BVHTree root node.
+ * @param packet   - the rays, each of which ends at its own t_max.
+ * @param active   - mask of the rays that may still reach this node.
+ * @param occluded - the bits of the rays found intercepted are set in this.
+ *
+ * @details Traces all rays of the packet at once in the same way as
+ * _isIntercepted (mode -1) traces a single ray, and with the same result
+ * for each of them. A subtree outside the frustum of the packet is skipped
+ * with one test, the bounding boxes are tested against all rays together
+ * and only the rays that reach a leaf are intersected with its surface.
+ * Rays drop out of the traversal as soon as they are found intercepted.
+ */
+void BVHTree::_getOcclusionMask(const BVHNode *node, const RayPacket &packet,
+                                unsigned int active,
+                                unsigned int &occluded) const {
+    if (node == nullptr)
+        return;
+
+    active &= ~occluded;
+    if (active == 0 || packet.frustumMisses(*node->thisBound))
+        return;
+
+    active = packet.intersectBox(*node->thisBound, active);
+    if (active == 0)
+        return;
+
+    if (node->left == nullptr && node->right == nullptr) {
+        const Surface *surface =
+                this->at(node->thisBound->getBoundedSurface());
+
+        for (int r = 0; r < packet.size; r++) {
+            if (!(active & (1u << r)))
+                continue;
+
+            if (surface->intercepts(packet.rays[r], packet.rays[r].t_max))
+                occluded |= 1u << r;
+        }
+        return;
+    }
+
+    _getOcclusionMask(node->left, packet, active, occluded);
+    _getOcclusionMask(node->right, packet, active, occluded);
 }
 
 /**
  * @name    getClosestSurface
  * @see     _getClosestSurface
+ *
+ * @param t_max - only surfaces closer than this are looked for; if there are
+ *                none the returned hit has no surface.
+ */
+template <int MODE>
+Hit BVHTree::getClosestSurface(const Ray &ray, float t_max) const {
+    Hit closest;
+    closest.t = t_max;
+
+    _getClosestSurface<MODE>(this->root, ray, closest);
+    return closest;
+}
+
+/**
+ * @name    getClosestSurface
+ * @brief   Finds the closest surface along the given ray, trying the
+ *          predicted primitive first.
+ *
+ * @param predictor - holds the primitive hit by the previous ray; updated
+ *                    with the primitive hit by this one.
+ * @param entry     - the node to start the search at instead of the root,
+ *                    @see getEntryNode
+ *
+ * @details If the ray hits the predicted primitive, that hit becomes the
+ * closest one before the search even starts, so every subtree whose bounding
+ * box lies beyond it is culled on its first box test. The search still finds
+ * any surface in front of it, so the result is the same as without a
+ * prediction.
+ *
+ * @see     _getClosestSurface for the rest of the parameters.
  */
-std::tuple<int, float>
-BVHTree::getClosestSurface(const Ray &ray, int mode) const {
-    auto closest = std::make_tuple(-1, numeric_limits<float>::infinity());
+template <int MODE>
+Hit BVHTree::getClosestSurface(const Ray &ray, HitPredictor &predictor,
+                               const BVHNode *entry) const {
+    Hit closest;
+
+    if (predictor.primitive != nullptr) {
+        Hit candidate;
+        float t = predictor.primitive->getIntersection(ray, candidate);
+
+        if (t >= 0.05 && t < closest.t) {
+            closest.t = t;
+            closest.surface_idx = predictor.surface_idx;
+            closest.primitive = predictor.primitive;
+            closest.u = candidate.u;
+            closest.v = candidate.v;
+            closest.geometric_normal = candidate.geometric_normal;
+            closest.smooth = candidate.smooth;
+        }
+    }
+
+    _getClosestSurface<MODE>(entry != nullptr ? entry : this->root, ray,
+                             closest);
+
+    predictor.searches++;
+    if (closest.primitive != nullptr &&
+        closest.primitive == predictor.primitive)
+        predictor.predicted++;
 
-    return _getClosestSurface(this->root, ray, mode, closest);
+    /*
+     * The primitives of a mesh belong to one of its levels of detail, which
+     * the mesh picks anew for every ray. Testing one directly could accept
+     * a hit on a level the next ray would not see, so their hits are not
+     * predicted.
+     */
+    predictor.surface_idx = closest.surface_idx;
+    predictor.primitive = (closest.surface_idx != -1 &&
+                           closest.primitive == this->at(closest.surface_idx))
+                          ? closest.primitive : nullptr;
+
+    return closest;
 }
 
 /**
  * @name    _getClosestSurface
  * @private used internally by BVHTree class (called by getClosestSurface)
- * @brief   Returns the closest surface along the given ray
+ * @brief   Finds the closest surface along the given ray
  *
- * @param node - the BVHTree root node.
- * @param ray  - the ray along which the closest surface is to be computed.
- * @param mode - 0|-1 => check interception with leaf node surfaces.
- *               1    => check interception with leaf node bounding box.
- *
- * @returns a tuple containing the index of the surface that was closest
- *          along with the intersection point of the ray and the surface or its
- *          bounding box depending on the mode.
+ * @param node    - the BVHTree root node.
+ * @param ray     - the ray along which the closest surface is to be computed.
+ * @tparam MODE   - 0|-1 => check interception with leaf node surfaces.
+ *                  1    => check interception with leaf node bounding box.
+ * @param closest - the closest hit found so far; updated in place with the
+ *                  index of the surface that was closest, the intersection
+ *                  parameter of the ray with the surface (or its bounding box
+ *                  depending on the mode) and its barycentric co-ordinates.
  *
  * @details to optimize further we first find the closest surface from the
  * left sub-tree and use that as comparison metric with the right sub-tree.
@@ -213,52 +346,205 @@ BVHTree::getClosestSurface(const Ray &ray, int mode) const {
  * intermediate bounding box is further away from the surface obtained from
  * the left sub-tree.
  */
-std::tuple<int, float>
-BVHTree::_getClosestSurface(const BVHNode *node, const Ray &ray, int mode,
-                            const std::tuple<int, float> &closest) const {
-    float t_max = get<1>(closest);
-
+template <int MODE>
+void BVHTree::_getClosestSurface(const BVHNode *node, const Ray &ray,
+                                 Hit &closest) const {
     if (node == nullptr)
-        return closest;
+        return;
+
+    nodes_visited++;
 
     /*
-     * If bounding box doesn't intersect with ray then dont bother going
-     * further and just return (-1, infinity)
+     * If bounding box doesn't intersect with ray or is further away than
+     * the closest hit so far then dont bother going further.
      */
     float t_bbox = node->thisBound->getIntersection(ray);
-    if (t_bbox == -1 || t_bbox > t_max)
-        return closest;
+    if (t_bbox == -1 || t_bbox > closest.t)
+        return;
 
     /*
      * If both left and right nodes are nullptr, the node is a leaf node and we
      * need to compute intersections with the actual surface. If there is an
-     * actual intersection with the surface then return those values else
-     * return (-1, infinity).
+     * actual intersection with the surface closer than the one recorded so
+     * far then record it.
      */
     if (node->left == nullptr && node->right == nullptr) {
         int surface_idx = node->thisBound->getBoundedSurface();
 
-        if (mode == 1 && t_bbox >= 0.05 && t_bbox < t_max)
-            return make_tuple(surface_idx, t_bbox);
-
-        float t = this->at(surface_idx)->getIntersection(ray);
-
-        return (t >= 0.05 && t < t_max)
-               ? make_tuple(surface_idx, t) : closest;
+        Surface *surface = this->at(surface_idx);
+
+        if (MODE == 1 && t_bbox >= 0.05 && t_bbox < closest.t) {
+            closest.t = t_bbox;
+            closest.surface_idx = surface_idx;
+            closest.primitive = surface;
+            return;
+        }
+
+        Hit candidate;
+        candidate.t = closest.t;
+        float t = surface->getIntersection(ray, candidate);
+
+        if (t >= 0.05 && t < closest.t) {
+            closest.t = t;
+            closest.surface_idx = surface_idx;
+            closest.primitive = (candidate.primitive != nullptr)
+                                ? candidate.primitive : surface;
+            closest.u = candidate.u;
+            closest.v = candidate.v;
+            closest.geometric_normal = candidate.geometric_normal;
+            closest.smooth = candidate.smooth;
+        }
+        return;
     }
 
     /**
      * At this point we know the bounding box intersects the ray, so now we
-     * check for intersections with the left and right nodes and get the
-     * closest surface from each side. Between the two of them return the one
-     * that is closer.
+     * check for intersections with the left and then the right node, each
+     * of them tightening the closest hit found so far.
      */
-    tuple<int, float> closest_l, closest_r;
+    this->_getClosestSurface<MODE>(node->left, ray, closest);
+    this->_getClosestSurface<MODE>(node->right, ray, closest);
+}
+
+/**
+ * @name    getClosestSurfaces
+ * @see     _getClosestSurfaces
+ */
+template <int MODE>
+void BVHTree::getClosestSurfaces(const RayPacket &packet, Hit *closest,
+                                 const BVHNode *entry) const {
+    for (int r = 0; r < packet.size; r++)
+        closest[r] = Hit();
+
+    _getClosestSurfaces<MODE>(entry != nullptr ? entry : this->root, packet,
+                              packet.activeMask(), closest);
+}
+
+/**
+ * @name    getEntryNode
+ * @brief   Finds the node at which the searches for rays within a frustum
+ *          can start instead of the root.
+ *
+ * @param frustum - encloses the rays, such as the primary rays of a tile.
+ * @param depth   - receives the depth of the node below the root.
+ *
+ * @returns the deepest node whose subtree holds every leaf the frustum may
+ *          reach, or nullptr if it reaches none (the rays miss the scene).
+ *
+ * @details Walks down from the root for as long as the frustum reaches only
+ * one of the children of the node. The subtrees left behind are outside the
+ * frustum, so no ray within it would get past their bounding boxes, and a
+ * search started at the returned node finds the same closest hit as one
+ * started at the root.
+ */
+const BVHNode *BVHTree::getEntryNode(const Frustum &frustum,
+                                     int &depth) const {
+    const BVHNode *node = this->root;
+    depth = 0;
+
+    if (node == nullptr || frustum.misses(*node->thisBound))
+        return nullptr;
+
+    while (node->left != nullptr || node->right != nullptr) {
+        bool left = node->left != nullptr &&
+                    !frustum.misses(*node->left->thisBound);
+        bool right = node->right != nullptr &&
+                     !frustum.misses(*node->right->thisBound);
+
+        if (left && right)
+            break;
+
+        if (!left && !right)
+            return nullptr;
+
+        node = left ? node->left : node->right;
+        depth++;
+    }
+    return node;
+}
+
+/**
+ * @name    _getClosestSurfaces
+ * @private used internally by BVHTree class (called by getClosestSurfaces)
+ * @brief   Finds the closest surface along each ray of a packet.
+ *
+ * @param node    - the BVHTree root node.
+ * @param packet  - the rays.
+ * @tparam MODE   - -1|1, @see _getClosestSurface
+ * @param active  - mask of the rays that may still find a closer hit in
+ *                  this node.
+ * @param closest - the closest hit found so far along each ray; updated in
+ *                  place.
+ *
+ * @details Traces all rays of the packet at once in the same way as
+ * _getClosestSurface traces a single ray, and with the same result for each
+ * of them: every ray tests the same nodes in the same order and culls them
+ * against its own closest hit. A node is visited once for the whole packet.
+ * Packets of rays from a shared origin skip nodes that all of them miss with
+ * a single interval test, before testing the rays one by one.
+ */
+template <int MODE>
+void BVHTree::_getClosestSurfaces(const BVHNode *node,
+                                  const RayPacket &packet,
+                                  unsigned int active, Hit *closest) const {
+    if (node == nullptr)
+        return;
+
+    nodes_visited++;
 
-    closest_l = this->_getClosestSurface(node->left, ray, mode, closest);
-    closest_r = this->_getClosestSurface(node->right, ray, mode, closest_l);
+    float t_far = 0;
+    for (int r = 0; r < packet.size; r++)
+        if (active & (1u << r))
+            t_far = fmaxf(t_far, closest[r].t);
 
-    return closest_r;
+    if (packet.intervalMisses(*node->thisBound, t_far))
+        return;
+
+    float t_bbox[RAY_PACKET_SIZE];
+    active = packet.intersectBox(*node->thisBound, active, t_bbox);
+
+    for (int r = 0; r < packet.size; r++)
+        if (t_bbox[r] > closest[r].t)
+            active &= ~(1u << r);
+
+    if (active == 0)
+        return;
+
+    if (node->left == nullptr && node->right == nullptr) {
+        int surface_idx = node->thisBound->getBoundedSurface();
+        Surface *surface = this->at(surface_idx);
+
+        for (int r = 0; r < packet.size; r++) {
+            if (!(active & (1u << r)))
+                continue;
+
+            if (MODE == 1 && t_bbox[r] >= 0.05 && t_bbox[r] < closest[r].t) {
+                closest[r].t = t_bbox[r];
+                closest[r].surface_idx = surface_idx;
+                closest[r].primitive = surface;
+                continue;
+            }
+
+            Hit candidate;
+            candidate.t = closest[r].t;
+            float t = surface->getIntersection(packet.rays[r], candidate);
+
+            if (t >= 0.05 && t < closest[r].t) {
+                closest[r].t = t;
+                closest[r].surface_idx = surface_idx;
+                closest[r].primitive = (candidate.primitive != nullptr)
+                                       ? candidate.primitive : surface;
+                closest[r].u = candidate.u;
+                closest[r].v = candidate.v;
+                closest[r].geometric_normal = candidate.geometric_normal;
+                closest[r].smooth = candidate.smooth;
+            }
+        }
+        return;
+    }
+
+    _getClosestSurfaces<MODE>(node->left, packet, active, closest);
+    _getClosestSurfaces<MODE>(node->right, packet, active, closest);
 }
 
 void BVHTree::printTree() const {
@@ -301,3 +587,30 @@ Surface *BVHTree::at(int index) const {
     return this->surfaces->at((unsigned long) index);
 }
 
+
+/*
+ * The searches for every run mode, which the Camera picks from once per
+ * render. Without acceleration (mode 0) they are never called, but they are
+ * named by the rendering code compiled for that mode.
+ */
+template bool BVHTree::isIntercepted<-1>(const Ray &, float) const;
+template bool BVHTree::isIntercepted<0>(const Ray &, float) const;
+template bool BVHTree::isIntercepted<1>(const Ray &, float) const;
+
+template Hit BVHTree::getClosestSurface<-1>(const Ray &, float) const;
+template Hit BVHTree::getClosestSurface<0>(const Ray &, float) const;
+template Hit BVHTree::getClosestSurface<1>(const Ray &, float) const;
+
+template Hit BVHTree::getClosestSurface<-1>(const Ray &, HitPredictor &,
+                                            const BVHNode *) const;
+template Hit BVHTree::getClosestSurface<0>(const Ray &, HitPredictor &,
+                                           const BVHNode *) const;
+template Hit BVHTree::getClosestSurface<1>(const Ray &, HitPredictor &,
+                                           const BVHNode *) const;
+
+template void BVHTree::getClosestSurfaces<-1>(const RayPacket &, Hit *,
+                                              const BVHNode *) const;
+template void BVHTree::getClosestSurfaces<0>(const RayPacket &, Hit *,
+                                             const BVHNode *) const;
+template void BVHTree::getClosestSurfaces<1>(const RayPacket &, Hit *,
+                                             const BVHNode *) const;
@@ -166,54 +166,50 @@ Vector BoundingBox::getSurfaceNormal(const Point &p) const {
  *
  * @param ray    - the ray with which intersection needs to be checked.
  * @returns      - the parameterized location of the intersection point on
- *                 the ray.
- * @retval   -1  - if the ray doesn't intersect with the bounding box.
+ *                 the ray, clamped to the start of the ray segment.
+ * @retval   -1  - if the segment [t_min, t_max] of the ray doesn't intersect
+ *                 with the bounding box.
  *
- * @note - remember the case when ray is parallel to any of the axes.
- * @note - if ray direction along any axis is negative the max side will be
- *         struck first on that axis. In such a case the intersection points
- *         corresponding to the min and max planes should be swapped with
- *         each other.
+ * @details Slab test using the reciprocal direction and sign bits carried by
+ * the ray, so it takes only multiplications, selects and min/max and no
+ * data-dependent branches. If the ray direction along an axis is negative the
+ * max plane on that axis is struck first, hence the sign decides which plane
+ * is near and which is far.
+ *
+ * @note - when a ray parallel to an axis starts exactly on a slab plane the
+ *         product 0 * inf is NaN. The min/max below are written such that a
+ *         NaN operand is never selected, so that slab is simply ignored.
+ *         A parallel ray outside a slab gets infinite plane distances of the
+ *         same sign and misses the box as it should.
  */
 float BoundingBox::getIntersection(const Ray &ray) const {
-    float t_x_min, t_x_max, t_y_min, t_y_max, t_z_min, t_z_max;
-    float t_min = 0;
-    float t_max = std::numeric_limits<float>::infinity();
-
-    if (ray.direction.i == 0 && (ray.origin.x < x_min || ray.origin.x > x_max))
-        return -1;
-
-    t_x_min = (x_min - ray.origin.x) / ray.direction.i;
-    t_x_max = (x_max - ray.origin.x) / ray.direction.i;
-
-    if (ray.direction.i < 0) std::swap(t_x_min, t_x_max);
-
-    t_min = fmaxf(t_min, t_x_min);
-    t_max = fminf(t_max, t_x_max);
-
-    if (ray.direction.j == 0 && (ray.origin.y < y_min || ray.origin.y > y_max))
-        return -1;
-
-    t_y_min = (y_min - ray.origin.y) / ray.direction.j;
-    t_y_max = (y_max - ray.origin.y) / ray.direction.j;
-
-    if (ray.direction.j < 0) std::swap(t_y_min, t_y_max);
+    float t_min = ray.t_min;
+    float t_max = ray.t_max;
+    float t_near, t_far;
 
-    if (t_y_min > t_max) return -1;
+    t_near = ((ray.sign[0] ? x_max : x_min) - ray.origin.x)
+             * ray.inv_direction.i;
+    t_far = ((ray.sign[0] ? x_min : x_max) - ray.origin.x)
+            * ray.inv_direction.i;
 
-    t_min = fmaxf(t_min, t_y_min);
-    t_max = fminf(t_max, t_y_max);
+    t_min = (t_near > t_min) ? t_near : t_min;
+    t_max = (t_far < t_max) ? t_far : t_max;
 
-    if (ray.direction.k == 0 && (ray.origin.z < z_min || ray.origin.z > z_max))
-        return -1;
+    t_near = ((ray.sign[1] ? y_max : y_min) - ray.origin.y)
+             * ray.inv_direction.j;
+    t_far = ((ray.sign[1] ? y_min : y_max) - ray.origin.y)
+            * ray.inv_direction.j;
 
-    t_z_min = (z_min - ray.origin.z) / ray.direction.k;
-    t_z_max = (z_max - ray.origin.z) / ray.direction.k;
+    t_min = (t_near > t_min) ? t_near : t_min;
+    t_max = (t_far < t_max) ? t_far : t_max;
 
-    if (ray.direction.k < 0) std::swap(t_z_min, t_z_max);
+    t_near = ((ray.sign[2] ? z_max : z_min) - ray.origin.z)
+             * ray.inv_direction.k;
+    t_far = ((ray.sign[2] ? z_min : z_max) - ray.origin.z)
+            * ray.inv_direction.k;
 
-    t_min = fmaxf(t_min, t_z_min);
-    t_max = fminf(t_max, t_z_max);
+    t_min = (t_near > t_min) ? t_near : t_min;
+    t_max = (t_far < t_max) ? t_far : t_max;
 
     return (t_min > t_max) ? -1 : t_min;
 }
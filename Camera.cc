@@ -7,8 +7,10 @@
 
 #include <tuple>
 #include <limits>
+#include <cstring>
+#include <algorithm>
 #include "include/Camera.h"
-#include "include/ProgressBar.h"
+#include "include/Kernels.h"
 
 using namespace Imf;
 using namespace std;
@@ -62,6 +64,38 @@ void Camera::setValues(float x, float y, float z,
     this->ph = ph;
 }
 
+/**
+ * @brief   The bit pattern of a float, used to seed samplers by position.
+ */
+static inline unsigned int floatBits(float f) {
+    unsigned int bits;
+    memcpy(&bits, &f, sizeof(bits));
+    return bits;
+}
+
+/**
+ * @name    shadowWindow
+ * @brief   Picks the area light samples for one primary sample of a pixel.
+ *
+ * @param seed      - the seed of the pixel.
+ * @param k         - index of the primary sample.
+ * @param p_samples - number of primary samples of the pixel.
+ * @param options   - options.shadow_budget is the total number of samples
+ *                    per area light for the whole pixel.
+ *
+ * @returns         - without a shadow budget, an empty window: every hit
+ *                    takes options.s_samples samples of its own. Otherwise
+ *                    the k-th of p_samples windows over a single set of
+ *                    shadow_budget samples shared by the pixel.
+ */
+SampleWindow Camera::shadowWindow(unsigned int seed, int k, int p_samples,
+                                  const RenderOptions &options) {
+    if (options.shadow_budget <= 0)
+        return SampleWindow();
+
+    return SampleWindow(seed, k, p_samples, options.shadow_budget);
+}
+
 /**
  * @name    getPixelSample
  * @brief   Finds the co-ordinates of a sample point on the given pixel.
@@ -70,26 +104,21 @@ void Camera::setValues(float x, float y, float z,
  * @param j         - the column index of the pixel
  * @param width     - the width of the image plane
  * @param height    - the height of the image plane
- * @param p         - the column index of the block on a pixel
- * @param q         - the row index of the block on a pixel
- * @param strata    - the number of blocks along the row and column the pixel
- *                    needs to be split into.
+ * @param x_d | @param y_d - the position of the sample within the pixel,
+ *                    both in [0, 1], as obtained from a Sampler.
  * @returns         - the sample point co-ordinates for the given pixel
  */
 Point Camera::getPixelSample(int i, int j, float width, float height,
-                             int p, int q, int strata) const {
+                             float x_d, float y_d) const {
     Point sample;
 
-    float x_d = (p + ((float) rand() / RAND_MAX)) / strata;
-    float y_d = (q + ((float) rand() / RAND_MAX)) / strata;
-
     float x = left + width * (i + x_d) / pw;
     float y = bottom + height * (j + y_d) / ph;
 
     sample = eye
-            .moveAlong(u.times(x))
-            .moveAlong(v.times(y))
-            .moveAlong(w.times(-d));
+            .moveAlong(u, x)
+            .moveAlong(v, y)
+            .moveAlong(w, -d);
 
 //    sample.printPoint();
 
@@ -107,27 +136,81 @@ Point Camera::getPixelSample(int i, int j, float width, float height,
  *                         therefore needs to be ignored if an intersection is
  *                         found with it.
  *
- * @returns        - a tuple containing the index of the closest intersecting
- *                   surface and the parameter representing the intersection
- *                   point on the view ray.
+ * @param predictor      - if given (for primary rays), the primitive hit by
+ *                         the previous primary ray is tested first.
+ * @param entry          - with a predictor, the BVHTree node to start the
+ *                         search at, nullptr for the root.
+ *
+ * @returns        - a hit record holding the index of the closest intersecting
+ *                   surface, the parameter representing the intersection
+ *                   point on the view ray and its barycentric co-ordinates.
  */
-tuple<int, float> Camera::getClosestSurface(const BVHTree &surfaces,
-                                            const Ray &ray, int mode) const {
-    if (mode != 0)
-        return surfaces.getClosestSurface(ray, mode);
+template <int MODE>
+Hit Camera::getClosestSurface(const BVHTree &surfaces, const Ray &ray,
+                              HitPredictor *predictor,
+                              const BVHNode *entry) const {
+    if (MODE == -1 && predictor != nullptr)
+        return surfaces.getClosestSurface<MODE>(ray, *predictor, entry);
 
-    float min_t = numeric_limits<float>::infinity();
-    int min_i = -1;
+    if (MODE != 0)
+        return surfaces.getClosestSurface<MODE>(ray);
+
+    Hit closest;
 
     for (int i = 0; i < surfaces.size(); i++) {
-        float t = surfaces.at(i)->getIntersection(ray);
+        Hit candidate;
+        candidate.t = closest.t;
+        float t = surfaces.at(i)->getIntersection(ray, candidate);
 
-        if (t >= 0.01 && t < min_t) {
-            min_t = t;
-            min_i = i;
+        if (t >= 0.01 && t < closest.t) {
+            closest = candidate;
+            closest.t = t;
+            closest.surface_idx = i;
+
+            if (closest.primitive == nullptr)
+                closest.primitive = surfaces.at(i);
         }
     }
-    return make_tuple(min_i, min_t);
+    return closest;
+}
+
+/**
+ * @name    resolveHit
+ * @brief   Completes the hit record of the closest surface along a ray with
+ *          the intersection point, the normal and the facing of the surface.
+ *
+ * @param surfaces - collection of all the surfaces in the scene.
+ * @param ray      - the ray along which the hit was found.
+ * @param hit      - the closest hit along the ray; must have a valid surface.
+ * @tparam MODE    - @see README.md - Run Modes
+ *
+ * @details This is done exactly once per hit so that shading from every light
+ * sample can reuse the normal instead of asking the surface for it again. If
+ * the ray hits the back side of the surface the normal is inverted. The
+ * normal and facing are those of the primitive that was actually hit, which
+ * for a mesh is one of its triangles or quads. The facing comes from the face
+ * normal recorded in the hit, and only smooth primitives are asked for their
+ * shading normal.
+ */
+template <int MODE>
+void Camera::resolveHit(const BVHTree &surfaces, const Ray &ray,
+                        Hit &hit) const {
+    hit.point = ray.getPointOnIt(hit.t);
+
+    if (MODE == 1) {
+        Surface *surface = surfaces.at(hit.surface_idx);
+
+        hit.normal = surface->bbox->getSurfaceNormal(hit.point);
+        hit.front_faced = true;
+        return;
+    }
+
+    hit.normal = hit.smooth ? hit.primitive->getSurfaceNormal(hit)
+                            : hit.geometric_normal;
+    hit.front_faced = (hit.geometric_normal.dot(ray.direction) <= 0);
+
+    if (!hit.front_faced)
+        hit.normal = -hit.normal;
 }
 
 /**
@@ -146,10 +229,11 @@ tuple<int, float> Camera::getClosestSurface(const BVHTree &surfaces,
  * @retval FALSE - A surface doesn't intercept the ray before reaching its
  *                 destination.
  */
+template <int MODE>
 bool Camera::isIntercepted(const BVHTree &surfaces,
-                           const Ray &ray, float t_max, int mode) const {
-    if (mode != 0)
-        return surfaces.isIntercepted(ray, t_max, mode);
+                           const Ray &ray, float t_max) const {
+    if (MODE != 0)
+        return surfaces.isIntercepted<MODE>(ray, t_max);
 
     for (int i = 0; i < surfaces.size(); i++) {
         float t = surfaces.at(i)->getIntersection(ray);
@@ -159,51 +243,377 @@ bool Camera::isIntercepted(const BVHTree &surfaces,
     return false;
 }
 
+/**
+ * @name aimLightRay
+ * @brief limits a ray from a point light to the intersection point it is
+ * cast towards.
+ *
+ * @param light_ray    - the ray from the light towards the intersection.
+ * @param view_ray     - the ray from viewer to surface.
+ * @param hit          - the resolved hit record of view ray on the surface.
+ *
+ * @returns        - the parameterized representation of the intersection
+ *                   point on the light ray.
+ */
+static float aimLightRay(Ray &light_ray, const Ray &view_ray, const Hit &hit) {
+    float t_max = light_ray.getOffsetFromOrigin(hit.point);
+
+    /* The light ray narrows down to the footprint of the view ray */
+    light_ray.cone_spread = view_ray.getFootprint(hit.t) / t_max;
+
+    /* Boxes beyond the intersection point need not be visited */
+    light_ray.t_max = t_max;
+
+    return t_max;
+}
+
+/**
+ * @name shadeFromPointLight
+ * @brief obtains the shade on the surface from a single point light.
+ *
+ * @param light        - the point light source.
+ * @param surfaces     - a collection of all the surfaces.
+ * @param material     - material of the surface on which diffuse shading
+ *                      needs to be computed.
+ * @param view_ray     - the ray from viewer to surface.
+ * @param hit          - the resolved hit record of view ray on the surface.
+ * @tparam MODE        - @see README.md - Run Modes
+ *
+ * @returns        - the diffuse and specular shading obtained on the given
+ *                   surface at the given intersection point from the light,
+ *                   black if the light is blocked by another surface.
+ */
+template <int MODE>
+RGB Camera::shadeFromPointLight(const PointLight *light,
+                                const BVHTree &surfaces,
+                                const Material &material,
+                                const Ray &view_ray,
+                                const Hit &hit) const {
+    /*
+     * A light ray going from the light source to the point of
+     * intersection on the surface.
+     */
+    Ray light_ray(light->position,
+                  hit.point.sub(light->position).norm());
+
+    float t_max = aimLightRay(light_ray, view_ray, hit);
+
+    /*
+     * If a light ray is not intercepted by another surface on its way
+     * to the intersection point then compute the diffuse and specular
+     * shading on the surface.
+     */
+    if (isIntercepted<MODE>(surfaces, light_ray, t_max))
+        return RGB(0, 0, 0);
+
+    return material.phongShading(light->color, light_ray, view_ray, hit);
+}
+
+/**
+ * @name sampleSquareLight
+ * @brief casts a single shadow ray towards a point on a square light and
+ * accumulates the shade it brings.
+ *
+ * @param light    - the square light source.
+ * @param u_d | @param v_d - the position of the sample on the area light,
+ *                   @see SquareLight::getLightSample
+ * @param shade    - the (unnormalized) shade from the sample is added to this.
+ *
+ * @returns        - true if the sample on the light is visible from the
+ *                   intersection point, false if it is in shadow.
+ *
+ * @see shadeFromPointLight for the rest of the parameters.
+ */
+template <int MODE>
+bool Camera::sampleSquareLight(const SquareLight *light,
+                               const BVHTree &surfaces,
+                               const Material &material,
+                               const Ray &view_ray,
+                               const Hit &hit,
+                               float u_d, float v_d,
+                               RGB &shade) const {
+    /* Obtaining the sample point on the area light */
+    Point light_sample = light->getLightSample(u_d, v_d);
+
+    Ray light_ray(light_sample, hit.point.sub(light_sample).norm());
+
+    float t_max = light_ray.getOffsetFromOrigin(hit.point);
+    light_ray.cone_spread = view_ray.getFootprint(hit.t) / t_max;
+    light_ray.t_max = t_max;
+
+    if (isIntercepted<MODE>(surfaces, light_ray, t_max))
+        return false;
+
+    /*
+     * Attenuating the shade of the light according to the angle made by the
+     * light ray and normal of the light
+     */
+    float cos = fmaxf(0, light_ray.direction.dot(light->w));
+    RGB light_color = light->color.times(cos);
+
+    shade.add(material.phongShading(light_color, light_ray, view_ray, hit));
+    return true;
+}
+
+/**
+ * @name sampleSquareLightPacket
+ * @brief casts shadow rays towards a few points on a square light together
+ * and accumulates the shade they bring.
+ *
+ * @param u_d | @param v_d - the positions of the samples on the area light.
+ * @param count    - the number of samples, at most RAY_PACKET_SIZE.
+ *
+ * @returns        - the number of samples visible from the intersection
+ *                   point.
+ *
+ * @details All the shadow rays end at the intersection point and start on
+ * the light, so they are traced through the BVHTree as one packet within
+ * the frustum spanned by the point and the light. The shade is accumulated
+ * in the same order, and with the same result, as by sampleSquareLight one
+ * sample at a time, which is what the other (debug) modes still do.
+ *
+ * @see sampleSquareLight for the rest of the parameters.
+ */
+template <int MODE>
+int Camera::sampleSquareLightPacket(const SquareLight *light,
+                                    const BVHTree &surfaces,
+                                    const Material &material,
+                                    const Ray &view_ray,
+                                    const Hit &hit,
+                                    const float *u_d, const float *v_d,
+                                    int count, RGB &shade) const {
+    int visible = 0;
+
+    /* A single ray (one shadow stratum) is not worth a frustum */
+    if (MODE != -1 || count == 1) {
+        for (int k = 0; k < count; k++)
+            if (sampleSquareLight<MODE>(light, surfaces, material, view_ray,
+                                        hit, u_d[k], v_d[k], shade))
+                visible++;
+        return visible;
+    }
+
+    RayPacket packet;
+    Point corners[4];
+    float footprint = view_ray.getFootprint(hit.t);
+
+    for (int k = 0; k < count; k++) {
+        Point light_sample = light->getLightSample(u_d[k], v_d[k]);
+
+        Ray light_ray(light_sample, hit.point.sub(light_sample).norm());
+
+        float t_max = light_ray.getOffsetFromOrigin(hit.point);
+        light_ray.cone_spread = footprint / t_max;
+        light_ray.t_max = t_max;
+
+        packet.add(light_ray);
+    }
+
+    light->getCorners(corners);
+    packet.setFrustum(hit.point, corners);
+
+    unsigned int occluded = surfaces.getOcclusionMask(packet);
+
+    for (int k = 0; k < count; k++) {
+        if (occluded & (1u << k))
+            continue;
+
+        const Ray &light_ray = packet.rays[k];
+        float cos = fmaxf(0, light_ray.direction.dot(light->w));
+        RGB light_color = light->color.times(cos);
+
+        shade.add(material.phongShading(light_color, light_ray, view_ray,
+                                        hit));
+        visible++;
+    }
+
+    return visible;
+}
+
+/**
+ * @name getSquareLightSamples
+ * @brief picks the set of samples a hit point takes from a square light.
+ *
+ * @param seed     - receives the seed of the set, for options.sampler.
+ *
+ * @returns        - the number of samples to take from the set. Without a
+ *                   shadow budget every point has a set of its own, seeded
+ *                   by its position, of which it takes all options.s_samples
+ *                   samples; otherwise it takes the window of the set shared
+ *                   by its pixel.
+ *
+ * @see shadeFromSquareLight for the rest of the parameters.
+ */
+int Camera::getSquareLightSamples(const SquareLight *light, const Hit &hit,
+                                  const RenderOptions &options,
+                                  const SampleWindow &window,
+                                  unsigned int &seed) const {
+    /* The samples come from a set shared by all samples of the pixel */
+    if (window.total > 0) {
+        seed = hashSeed(window.seed, floatBits(light->center.x) ^
+                                     floatBits(light->center.z));
+        return window.count;
+    }
+
+    seed = hashSeed(floatBits(hit.point.x) ^
+                    floatBits(hit.point.z) * 0x9e3779b9u,
+                    floatBits(hit.point.y) ^
+                    floatBits(light->center.x));
+    return options.s_samples;
+}
+
+/**
+ * @name shadeFromSquareLight
+ * @brief obtains the shade on the surface from a single square light.
+ *
+ * @param light    - the square light source.
+ * @param options  - the number of samples that need to be collected from the
+ *                   area light is options.s_samples, placed on it by
+ *                   options.sampler; with options.adaptive_shadows they are
+ *                   collected only in the penumbra.
+ * @param window   - if it has a shared set (a shadow budget is set), only
+ *                   the samples of the window are collected from that set,
+ *                   in place of options.s_samples of the point's own.
+ *
+ * @returns        - the diffuse shading obtained on the given surface at the
+ *                   given intersection point from the square light.
+ *
+ * @details For the most part the process of shading is exactly the same as
+ * that for point lights. But here since its an area light, we need to collect
+ * multiple samples from different sections of the area light. For each sample
+ * the shade obtained will be attenuated by the angle the light ray makes
+ * with the normal direction of the square light. Lastly each sample is
+ * collected, added together and normalized.
+ *
+ * Every shading point scrambles its samples differently (seeded by its
+ * position) so that the sampling pattern doesn't show up across the image.
+ *
+ * In adaptive mode a small stratified set of probe samples is collected
+ * first.
+ * If the probes agree on the visibility of the light the point is either
+ * fully lit or in the umbra, and the probes alone give its shade. Only when
+ * they disagree (the penumbra) is the full set of samples collected, and
+ * averaged together with the probes.
+ *
+ * @see shadeFromPointLight for some more details of the implemention.
+ */
+template <int MODE>
+RGB Camera::shadeFromSquareLight(const SquareLight *light,
+                                 const BVHTree &surfaces,
+                                 const Material &material,
+                                 const Ray &view_ray,
+                                 const Hit &hit,
+                                 const RenderOptions &options,
+                                 const SampleWindow &window) const {
+    RGB shade(0, 0, 0);
+    int samples = 0;
+    float u_d[RAY_PACKET_SIZE], v_d[RAY_PACKET_SIZE];
+
+    unsigned int seed;
+    int s_samples = getSquareLightSamples(light, hit, options, window, seed);
+
+    /* Probing is only worth it when it casts fewer rays than the full set */
+    if (options.adaptive_shadows && s_samples > ADAPTIVE_PROBE_SAMPLES) {
+        for (int k = 0; k < ADAPTIVE_PROBE_SAMPLES; k++)
+            options.sampler->get2D(k, ADAPTIVE_PROBE_SAMPLES,
+                                   hashSeed(seed), u_d[k], v_d[k]);
+
+        int visible = sampleSquareLightPacket<MODE>(light, surfaces, material,
+                                                    view_ray, hit, u_d, v_d,
+                                                    ADAPTIVE_PROBE_SAMPLES,
+                                                    shade);
+
+        samples = ADAPTIVE_PROBE_SAMPLES;
+
+        if (visible == 0 || visible == samples)
+            return shade.times(1.0f / samples);
+    }
+
+    for (int first = 0; first < s_samples; first += RAY_PACKET_SIZE) {
+        int count = min(RAY_PACKET_SIZE, s_samples - first);
+
+        for (int k = 0; k < count; k++) {
+            if (window.total > 0)
+                options.sampler->get2D(window.first + first + k,
+                                       window.total, seed, u_d[k], v_d[k]);
+            else
+                options.sampler->get2D(first + k, s_samples, seed,
+                                       u_d[k], v_d[k]);
+        }
+
+        sampleSquareLightPacket<MODE>(light, surfaces, material, view_ray,
+                                      hit, u_d, v_d, count, shade);
+    }
+
+    samples += s_samples;
+
+    /* Normalizing the shade accumulated over all samples */
+    return shade.times(1.0f / samples);
+}
+
 /**
  * @name diffuseFromPointLights
  * @brief obtains the shade on the surface from all the point lights in the
  * scene.
  *
- * @param plights      - a list of all point light sources.
- * @param surfaces     - a collection of all the surfaces.
- * @param surface      - surface on which diffuse shading needs to be computed.
- * @param view_ray     - the ray from viewer to surface.
- * @param intersection - the point of intersection of view ray on the surface.
- * @param mode         - @see README.md - Run Modes
+ * @param plights      - all point light sources, as a structure of arrays.
+ * @param options      - options.fast_pow picks the approximate pow for the
+ *                       highlights.
  *
  * @returns        - the diffuse shading obtained on the given surface at the
  *                   given intersection point after considering contributions
  *                   from all the point lights.
+ *
+ * @details The lights are taken LIGHT_LANES at a time. The shading model is
+ * first evaluated for all of them as if none were blocked, by the active
+ * Kernels. Shadow rays are then cast only from the lights that bring any
+ * light, and mask out the ones blocked. With the exact pow the result is the
+ * same to the bit as shading from one light at a time.
+ *
+ * @see shadeFromPointLight for the rest of the parameters.
  */
-RGB Camera::diffuseFromPointLights(const vector<PointLight *> &plights,
+template <int MODE>
+RGB Camera::diffuseFromPointLights(const PointLightArray &plights,
                                    const BVHTree &surfaces,
-                                   const Surface *surface,
+                                   const Material &material,
                                    const Ray &view_ray,
-                                   const Point &intersection,
-                                   int mode) const {
+                                   const Hit &hit,
+                                   const RenderOptions &options) const {
+    PointLightBlock block;
+
+    /* Back faces are shaded as in Material::phongShading */
+    RGB material_diffuse = hit.front_faced ? material.diffuse : RGB(1, 1, 0);
+    RGB material_specular = hit.front_faced ? material.specular
+                                            : RGB(0, 0, 0);
+    bool has_specular = hit.front_faced && !material.specular_free;
+
+    Vector v = -view_ray.direction;
+
     RGB shade(0, 0, 0);
-    for (PointLight *light : plights) {
-        /*
-         * A light ray going from the light source to the point of
-         * intersection on the surface.
-         */
-        Ray light_ray(light->position,
-                      intersection.sub(light->position).norm());
 
-        /*
-         * The parameterized representation of the intersection point with
-         * the surface on the light ray.
-         */
-        float t_max = light_ray.getOffsetFromOrigin(intersection);
+    for (size_t first = 0; first < plights.size(); first += LIGHT_LANES) {
+        Kernels::active->shadePointLights(plights, first, hit.point,
+                                          hit.normal, v, material_diffuse,
+                                          material_specular, material.phong,
+                                          has_specular, options.fast_pow,
+                                          block);
 
-        /*
-         * If a light ray is not intercepted by another surface on its way
-         * to the intersection point then compute the diffuse and specular
-         * shading on the surface.
-         */
-        if (!isIntercepted(surfaces, light_ray, t_max, mode))
-            shade.add(surface->phongShading(light->color, light_ray, view_ray,
-                                            intersection, mode));
+        size_t count = min((size_t) LIGHT_LANES, plights.size() - first);
+
+        for (size_t l = 0; l < count; l++) {
+            /* Lights that bring nothing need no shadow ray */
+            if (block.r[l] == 0 && block.g[l] == 0 && block.b[l] == 0)
+                continue;
+
+            Ray light_ray(Point(plights.x[first + l], plights.y[first + l],
+                                plights.z[first + l]),
+                          Vector(-block.ix[l], -block.iy[l], -block.iz[l]));
+
+            float t_max = aimLightRay(light_ray, view_ray, hit);
+
+            if (!isIntercepted<MODE>(surfaces, light_ray, t_max))
+                shade.add(RGB(block.r[l], block.g[l], block.b[l]));
+        }
     }
     return shade;
 }
@@ -214,61 +624,121 @@ RGB Camera::diffuseFromPointLights(const vector<PointLight *> &plights,
  * the scene.
  *
  * @param slights  - a list of all the sqaure lights in the scene
- * @param s_strata - the number of samples that need to be collected from the
- *                   area light are determined by this value.
  *
  * @returns        - the diffuse shading obtained on the given surface at the
  *                   given intersection point after considering contributions
  *                   from all the square lights.
  *
- * @details For the most part the process of shading is exactly the same as
- * that for point lights. But here since its an area light, we need to collect
- * multiple samples from different sections of the area light. For each sample
- * the shade obtained will be attenuated by the angle the light ray makes
- * with the normal direction of the square light. Lastly each sample is
- * collected, added together and normalized.
- *
- * @see diffuseFromPointLights for some more details of the implemention.
+ * @see shadeFromSquareLight for the rest of the parameters.
  */
+template <int MODE>
 RGB Camera::diffuseFromSquareLights(const vector<SquareLight *> &slights,
                                     const BVHTree &surfaces,
-                                    const Surface *surface,
+                                    const Material &material,
                                     const Ray &view_ray,
-                                    const Point &intersection,
-                                    int mode, int s_strata) const {
+                                    const Hit &hit,
+                                    const RenderOptions &options,
+                                    const SampleWindow &window) const {
     RGB shade(0, 0, 0);
-    float avg_factor = 1.0f / (s_strata * s_strata);
+    for (SquareLight *light : slights)
+        shade.add(shadeFromSquareLight<MODE>(light, surfaces, material,
+                                             view_ray, hit, options, window));
+    return shade;
+}
 
-    for (SquareLight *light :slights) {
-        for (int p = 0; p < s_strata; p++) {
-            for (int q = 0; q < s_strata; q++) {
-                /* Obtaining a random sample point on the area light */
-                Point light_sample = light->getLightSample(p, q, s_strata);
+/**
+ * @name diffuseFromLightTree
+ * @brief estimates the diffuse shading contributed by all the lights in the
+ * scene by shading from only a few of them.
+ *
+ * @param lights  - a LightTree over all the lights in the scene.
+ * @param options - the number of lights to pick is options.light_samples.
+ *
+ * @returns       - an unbiased estimate of the diffuse shading obtained on
+ *                  the given surface at the given intersection point from
+ *                  all the lights.
+ *
+ * @details Lights are picked from the tree with probability proportional to
+ * an estimate of their contribution at the intersection point. The shade from
+ * each picked light (including its shadow rays) is divided by the probability
+ * of picking it, so the cost per shading point stays the same however many
+ * lights there are.
+ */
+template <int MODE>
+RGB Camera::diffuseFromLightTree(const LightTree &lights,
+                                 const BVHTree &surfaces,
+                                 const Material &material,
+                                 const Ray &view_ray,
+                                 const Hit &hit,
+                                 const RenderOptions &options,
+                                 const SampleWindow &window) const {
+    RGB shade(0, 0, 0);
 
-                Ray light_ray(light_sample,
-                              intersection.sub(light_sample).norm());
+    for (int i = 0; i < options.light_samples; i++) {
+        float pdf;
+        int light_idx = lights.sample(hit.point, pdf);
 
-                float t_max = light_ray.getOffsetFromOrigin(intersection);
+        if (light_idx == -1 || pdf <= 0)
+            continue;
 
-                if (!isIntercepted(surfaces, light_ray,
-                                   t_max, mode)) {
+        /* Too far away to make a visible difference */
+        if (!lights.influences(light_idx, hit.point))
+            continue;
 
-                    /*
-                     * Attenuating the shade of the light according to the
-                     * angle made by the light ray and normal of the light
-                     */
-                    float cos = fmaxf(0, light_ray.direction.dot(light->w));
-                    RGB light_color = light->color.times(cos);
+        const LightEntry &light = lights.at(light_idx);
+        RGB c = (light.plight != nullptr)
+                ? shadeFromPointLight<MODE>(light.plight, surfaces, material,
+                                            view_ray, hit)
+                : shadeFromSquareLight<MODE>(light.slight, surfaces, material,
+                                             view_ray, hit, options, window);
 
-                    RGB c = surface->phongShading(light_color, light_ray,
-                                                  view_ray, intersection,
-                                                  mode);
+        shade.addTimes(c, 1.0f / (pdf * options.light_samples));
+    }
+    return shade;
+}
 
-                    /* Normalizing the shade obtained and accumulating it. */
-                    shade.add(c.times(avg_factor));
-                }
-            }
-        }
+/**
+ * @name diffuseFromInfluencingLights
+ * @brief obtains the diffuse shading contributed by the lights whose
+ * influence radius reaches the intersection point.
+ *
+ * @param lights  - a LightTree over all the lights in the scene, with a
+ *                  cutoff set.
+ * @param nearby  - scratch space for the indices of the influencing lights.
+ *
+ * @returns       - the diffuse shading obtained on the given surface at the
+ *                  given intersection point from all lights that may
+ *                  contribute more than the cutoff.
+ *
+ * @details Lights beyond their influence radius are skipped without casting
+ * a shadow ray or evaluating the shading model, so dim and far away lights
+ * cost only a walk down the LightTree.
+ *
+ * @see shadeFromSquareLight for the rest of the parameters.
+ */
+template <int MODE>
+RGB Camera::diffuseFromInfluencingLights(const LightTree &lights,
+                                         const BVHTree &surfaces,
+                                         const Material &material,
+                                         const Ray &view_ray,
+                                         const Hit &hit,
+                                         const RenderOptions &options,
+                                         const SampleWindow &window,
+                                         vector<int> &nearby) const {
+    RGB shade(0, 0, 0);
+
+    lights.getInfluencingLights(hit.point, nearby);
+
+    for (int light_idx : nearby) {
+        const LightEntry &light = lights.at(light_idx);
+
+        if (light.plight != nullptr)
+            shade.add(shadeFromPointLight<MODE>(light.plight, surfaces,
+                                                material, view_ray, hit));
+        else
+            shade.add(shadeFromSquareLight<MODE>(light.slight, surfaces,
+                                                 material, view_ray, hit,
+                                                 options, window));
     }
     return shade;
 }
@@ -278,102 +748,345 @@ RGB Camera::diffuseFromSquareLights(const vector<SquareLight *> &slights,
  * @brief   Computes the shading along the given view ray
  *
  * @param plights | @param slights | @param ambient - all the light sources.
+ * @param lights      - a LightTree over the point and square lights.
  * @param view_ray    - the ray along which shading needs to be computed.
+ * @param materials   - the material table of the scene.
  * @param surfaces    - contains all surfaces in two forms: BVHTree & array.
- * @param refl_limit  - the number of reflections allowed before the light
- *                      fades away.
- * @param origin_surface_idx - the index of the surface from which the ray is
- *                      coming from. Set to any negative value if ray is coming
- *                      from the viewer and not some surface.
+ * @param options     - @see RenderOptions; options.max_depth,
+ *                      options.throughput_epsilon and options.roulette
+ *                      decide when reflections fade away.
+ * @param window      - the area light samples to use along this ray,
+ *                      @see shadeFromSquareLight
+ * @param predictor   - predicts the first hit of the view ray from that of
+ *                      the previous one; nullptr for no prediction.
  *
  * @returns           - the RGB value (spectral distribution) obtained along
  *                      the given view ray
+ *
+ * @details The view ray is followed through its chain of mirror reflections
+ * in a loop. The throughput - the product of the reflective components of
+ * all surfaces bounced off so far - scales the shade picked up at each
+ * surface. The chain ends when it leaves the scene, hits a surface that does
+ * not reflect it, reaches options.max_depth surfaces, or once its throughput
+ * is too small to make a visible difference. With Russian roulette, chains
+ * whose throughput falls under options.roulette are also ended at random,
+ * and the survivors are boosted to make up for the ones ended.
  */
+template <int MODE>
 RGB Camera::getShadeAlongRay(const Ray &view_ray,
-                             const vector<PointLight *> &plights,
+                             const vector<Material> &materials,
+                             const PointLightArray &plights,
                              const vector<SquareLight *> &slights,
+                             const LightTree &lights,
                              const AmbientLight &ambient,
                              const BVHTree &surfaces,
-                             int refl_limit,
-                             int origin_surface_idx,
-                             int mode, int s_strata) const {
+                             const RenderOptions &options,
+                             const SampleWindow &window,
+                             HitPredictor *predictor) const {
     RGB shade(0, 0, 0);
+    RGB throughput(1, 1, 1);
+    Ray ray = view_ray;
+    vector<int> nearby;
 
-    /* No reflections beyond a limit */
-    if (refl_limit == 0) return shade;
+    for (int depth = 0; depth < options.max_depth; depth++) {
+        /* Get closest surface along the ray */
+        Hit hit = getClosestSurface<MODE>(surfaces, ray,
+                                          depth == 0 ? predictor : nullptr);
 
-    /* Get closest surface along the ray */
-    tuple<int, float> closest_surface;
-    closest_surface = getClosestSurface(surfaces, view_ray, mode);
+        if (hit.surface_idx == -1)
+            break;
 
-    int closest_surface_idx = get<0>(closest_surface);
-    float t = get<1>(closest_surface);
+        const Material &material =
+                materials[surfaces.at(hit.surface_idx)->material_idx];
 
-    if (closest_surface_idx != -1) {
-        Point intersection = view_ray.getPointOnIt(t);
-        Surface *surface = surfaces.at(closest_surface_idx);
+        resolveHit<MODE>(surfaces, ray, hit);
 
-        /* Get diffuse shading from all Point & Square Lights */
-        shade.add(diffuseFromPointLights(plights, surfaces, surface,
-                                         view_ray, intersection, mode));
-        shade.add(diffuseFromSquareLights(slights, surfaces, surface,
-                                          view_ray, intersection,
-                                          mode, s_strata));
+        RGB local(0, 0, 0);
+
+        /*
+         * Get diffuse shading from all Point & Square Lights, or from a few
+         * of them picked at random if there are too many. Black materials
+         * need no shadow rays as no light can reflect off their front faces.
+         */
+        bool lit = !material.black || !hit.front_faced;
+
+        if (lit && options.light_samples > 0) {
+            local.add(diffuseFromLightTree<MODE>(lights, surfaces, material,
+                                                 ray, hit, options, window));
+        } else if (lit && options.light_cutoff > 0) {
+            local.add(diffuseFromInfluencingLights<MODE>(lights, surfaces,
+                                                         material, ray, hit,
+                                                         options, window,
+                                                         nearby));
+        } else if (lit) {
+            local.add(diffuseFromPointLights<MODE>(plights, surfaces,
+                                                   material, ray, hit,
+                                                   options));
+            local.add(diffuseFromSquareLights<MODE>(slights, surfaces,
+                                                    material, ray, hit,
+                                                    options, window));
+        }
 
         /*
          * Ambient Light Shading
          * Note: Only add ambient light if computing shading for view ray
          * and not reflected/refracted rays.
          */
-        if (origin_surface_idx == -1)
-            shade.add(surface->getDiffuseComponent().scaleRGB(ambient.color));
+        if (depth == 0)
+            local.add(material.diffuse.scaleRGB(ambient.color));
+
+        shade.add(local.scaleRGB(throughput));
 
         /*
          * If the surface is reflective and is front-faced with respect to
-         * the view ray then compute shading from the reflected ray.
+         * the ray then continue along the reflected ray.
          */
-        bool isFrontFaced = mode == 1 || surface->isFrontFacedTo(view_ray);
-        if (surface->isReflective() && isFrontFaced) {
-            Vector normal = (mode == 1)
-                            ? surface->bbox->getSurfaceNormal(intersection)
-                            : surface->getSurfaceNormal(intersection);
-
-            /*
-             * Directional vector generated when the view_ray reflects off the
-             * surface.
-             */
-            Vector reflected_vector = view_ray.direction
-                    .plus(-normal.times(2 * view_ray.direction.dot(normal)))
-                    .norm();
-
-            Ray reflected_ray(intersection, reflected_vector);
-
-            /* The shade obtained from the reflected ray */
-            RGB reflection = this->getShadeAlongRay(reflected_ray, plights,
-                                                    slights, ambient, surfaces,
-                                                    refl_limit - 1,
-                                                    closest_surface_idx, mode,
-                                                    s_strata);
-
-            shade.add(reflection.scaleRGB(surface->getReflectiveComponent()));
+        if (!material.reflective || !hit.front_faced)
+            break;
+
+        throughput = throughput.scaleRGB(material.ideal_specular);
+
+        float strength = throughput.maxComponent();
+
+        if (strength < options.throughput_epsilon)
+            break;
+
+        if (strength < options.roulette) {
+            float survival = strength / options.roulette;
+
+            if (rand() / (RAND_MAX + 1.0) >= survival)
+                break;
+
+            throughput = throughput.times(1 / survival);
         }
+
+        /*
+         * Directional vector generated when the ray reflects off the
+         * surface.
+         */
+        float cos_i = ray.direction.dot(hit.normal);
+        Vector reflected_vector = ray.direction
+                .plusTimes(hit.normal, -2 * cos_i)
+                .norm();
+
+        Ray reflected_ray(hit.point, reflected_vector);
+
+        /* Treating the surface as flat the ray cone keeps spreading */
+        reflected_ray.cone_width = ray.getFootprint(hit.t);
+        reflected_ray.cone_spread = ray.cone_spread;
+
+        ray = reflected_ray;
     }
     return shade;
 }
 
+/**
+ * @name    samplePixelAdaptively
+ * @brief   Shades a pixel with as many primary samples as it needs.
+ *
+ * @param i | @param j  - the row and column index of the pixel.
+ * @param width | @param height - the size of the image plane.
+ * @param strata_order  - scratch space for the order in which the samples of
+ *                        the pixel are taken; at least aa_max_samples long.
+ * @param predictor     - @see getShadeAlongRay
+ * @param samples       - receives the number of samples taken.
+ * @param options       - options.aa_min_samples, options.aa_max_samples and
+ *                        options.aa_tolerance control the sampling.
+ *
+ * @returns             - the average shade of all samples taken.
+ *
+ * @details The pixel gets a set of aa_max_samples points from
+ * options.sampler. They are taken in a random order, so that the samples
+ * taken so far are always spread over the whole pixel,
+ * and a running mean and variance of the brightness of the samples is kept
+ * (Welford's method). Once aa_min_samples have been taken, sampling stops as
+ * soon as the standard error of the mean falls under aa_tolerance. Flat
+ * pixels thus stop early while edges, reflections and penumbrae go on up to
+ * aa_max_samples.
+ */
+template <int MODE>
+RGB Camera::samplePixelAdaptively(int i, int j, float width, float height,
+                                  float sample_spread,
+                                  const vector<Material> &materials,
+                                  const PointLightArray &plights,
+                                  const vector<SquareLight *> &slights,
+                                  const LightTree &lights,
+                                  const AmbientLight &ambient,
+                                  const BVHTree &surfaces,
+                                  const RenderOptions &options,
+                                  vector<int> &strata_order,
+                                  HitPredictor &predictor,
+                                  int &samples) const {
+    int blocks = options.aa_max_samples;
+    unsigned int seed = hashSeed((unsigned int) i, (unsigned int) j);
+    float x_d, y_d;
+
+    for (int k = 0; k < blocks; k++)
+        strata_order[k] = k;
+
+    RGB shade(0, 0, 0);
+    float mean = 0, m2 = 0;
+
+    for (samples = 0; samples < options.aa_max_samples;) {
+        /* Picking the next point at random from those not yet taken */
+        int pick = samples + rand() % (blocks - samples);
+        swap(strata_order[samples], strata_order[pick]);
+
+        options.sampler->get2D(strata_order[samples], blocks, seed,
+                               x_d, y_d);
+        Point px_sample = this->getPixelSample(j, i, width, height, x_d, y_d);
+
+        Ray view_ray(this->eye, px_sample.sub(this->eye).norm());
+        view_ray.cone_spread = sample_spread;
+
+        SampleWindow window = shadowWindow(seed, strata_order[samples],
+                                           blocks, options);
+
+        RGB c = getShadeAlongRay<MODE>(view_ray, materials, plights, slights,
+                                       lights, ambient, surfaces, options,
+                                       window, &predictor);
+        shade.add(c);
+        samples++;
+
+        /* Updating the running mean and variance of the brightness */
+        float y = (c.r + c.g + c.b) / 3;
+        float delta = y - mean;
+        mean += delta / samples;
+        m2 += delta * (y - mean);
+
+        if (samples >= options.aa_min_samples && samples > 1) {
+            float variance = m2 / (samples - 1);
+            if (sqrtf(variance / samples) <= options.aa_tolerance)
+                break;
+        }
+    }
+    return shade.times(1.0f / samples);
+}
+
+/**
+ * @name    renderPixels
+ * @brief   Renders every pixel of the image, with the renderer compiled for
+ *          one run mode.
+ *
+ * @param lights        - a LightTree over the point and square lights.
+ * @param width | @param height - the size of the image plane.
+ * @param p_samples     - primary samples per pixel; with adaptive sampling
+ *                        the most a pixel may take.
+ * @param sample_spread - angle subtended by a single pixel sample at the eye,
+ *                        spread over p_samples samples.
+ * @param predictor     - predicts the first hit of each primary ray.
+ * @param progress      - reports how much of the image is done.
+ * @param stats         - counters of the wavefront renderer.
+ * @param total_samples - with adaptive sampling, receives the number of
+ *                        primary samples taken over the whole image.
+ *
+ * @tparam MODE - @see README.md - Run Modes. All of the rendering code below
+ * this point is compiled for each mode, so the tests of the mode deep in the
+ * traversals and the shading are resolved at compile time and the branches
+ * of the other modes are dropped.
+ *
+ * @see render for the rest of the parameters.
+ */
+template <int MODE>
+void Camera::renderPixels(Array2D <Rgba> &pixels,
+                          const vector<Material> &materials,
+                          const vector<PointLight *> &plights,
+                          const vector<SquareLight *> &slights,
+                          const LightTree &lights,
+                          const AmbientLight &ambient,
+                          const BVHTree &surfaces,
+                          const RenderOptions &options,
+                          float width, float height,
+                          int p_samples, float sample_spread,
+                          HitPredictor &predictor,
+                          ProgressBar &progress,
+                          WavefrontStats &stats,
+                          long &total_samples) const {
+    if (options.wavefront) {
+        renderWavefront<MODE>(pixels, materials, plights, slights, lights,
+                              ambient, surfaces, options, width, height,
+                              sample_spread, predictor, progress, stats);
+        return;
+    }
+
+    float total_pixels = this->ph * this->pw;
+    bool adaptive = options.aa_max_samples > 0;
+
+    vector<int> strata_order(p_samples);
+    PointLightArray light_array(plights);
+
+    for (int i = 0; i < this->ph; i++) {
+        for (int j = 0; j < this->pw; j++) {
+            RGB shade(0, 0, 0);
+
+            if (adaptive) {
+                int samples;
+                shade = samplePixelAdaptively<MODE>(i, j, width, height,
+                                                    sample_spread,
+                                                    materials, light_array,
+                                                    slights, lights,
+                                                    ambient, surfaces,
+                                                    options, strata_order,
+                                                    predictor, samples);
+                total_samples += samples;
+            } else {
+                unsigned int seed = hashSeed((unsigned int) i,
+                                             (unsigned int) j);
+
+                for (int k = 0; k < p_samples; k++) {
+                    Point px_sample;
+                    float x_d, y_d;
+
+                    options.sampler->get2D(k, p_samples, seed,
+                                           x_d, y_d);
+                    px_sample = this->getPixelSample(j, i, width, height,
+                                                     x_d, y_d);
+
+                    // TODO: should this ray originate from px_sample or
+                    // eye?
+                    Ray view_ray(this->eye,
+                                 px_sample.sub(this->eye).norm());
+                    view_ray.cone_spread = sample_spread;
+
+                    SampleWindow window = shadowWindow(seed, k,
+                                                       p_samples,
+                                                       options);
+
+                    shade.add(getShadeAlongRay<MODE>(view_ray, materials,
+                                                     light_array, slights,
+                                                     lights, ambient,
+                                                     surfaces, options,
+                                                     window, &predictor));
+                }
+
+                float avg_factor = 1.0f / p_samples;
+                shade = shade.times(avg_factor);
+            }
+
+            Rgba &px = pixels[i][j];
+            px.r = shade.r;
+            px.g = shade.g;
+            px.b = shade.b;
+            px.a = 1;
+
+            progress.log((i + 1) * (j + 1), total_pixels);
+        }
+    }
+}
+
 /**
  * @name    render
  * @brief   Renders the image using the ray tracing algorithm.
  *
  * @param pixels    - a two dimensional array of pixels representing the image.
  * @param surfaces  - a vector of all the surfaces in the scene.
- * @param materials - a vector of all the materials used.
+ * @param materials - the material table: all the materials used, which
+ *                    surfaces refer to by index.
  * @param plights   - a vector of all the point lights in the scene.
  * @param slights   - a vector of all the square lights in the scene.
  * @param ambient   - an ambient light added to the scene.
- * @param mode      - @see README.md - Run Modes
- * @param p_strata  - number of primary ray samples
- * @param s_strata  - number of area light (shadow ray) samples
+ * @param options   - @see RenderOptions; notably the run mode and the number
+ *                    of primary and area light (shadow ray) samples.
  *
  * @details For every pixel in the image, construct rays that originates
  *          from the camera eye and passes via points on the pixel. Now trace
@@ -383,19 +1096,58 @@ RGB Camera::getShadeAlongRay(const Ray &view_ray,
  *          the shading for each pixel.
  */
 void Camera::render(Array2D <Rgba> &pixels, const vector<Surface *> &surfaces,
-                    const vector<Material *> &materials,
+                    const vector<Material> &materials,
                     const vector<PointLight *> &plights,
                     const vector<SquareLight *> &slights,
                     const AmbientLight &ambient,
-                    int mode, int p_strata, int s_strata) const {
+                    const RenderOptions &options) const {
+    int mode = options.mode;
+    int p_samples = options.p_samples;
 
     float w = this->right - this->left;
     float h = this->top - this->bottom;
     float total_pixels = this->ph * this->pw;
 
+    /*
+     * Adaptive sampling splits pixels finely enough for all its samples.
+     * Both the sample spread below and the strata of renderPixels follow
+     * from this one count.
+     */
+    bool adaptive = options.aa_max_samples > 0;
+    if (adaptive)
+        p_samples = options.aa_max_samples;
+
+    long total_samples = 0;
+
+    HitPredictor predictor;
+    WavefrontStats stats;
+
+    /* Angle subtended by a single pixel sample at the eye */
+    float sample_spread = w / this->pw / this->d / sqrtf((float) p_samples);
+
     pixels.resizeErase(this->ph, this->pw);
 
     BVHTree surfaceTree(&surfaces);
+    LightTree lightTree(plights, slights);
+
+    if (options.light_cutoff > 0) {
+        /* Back faces are shaded with a diffuse component of 1 */
+        float max_reflectance = 1;
+
+        for (const Material &material : materials)
+            max_reflectance = fmaxf(max_reflectance,
+                                    material.diffuse.maxComponent() +
+                                    material.specular.maxComponent());
+
+        lightTree.setCutoff(options.light_cutoff, max_reflectance);
+
+        cout << "Skipping lights contributing less than "
+             << options.light_cutoff << endl;
+    }
+
+    if (options.light_samples > 0)
+        cout << "Sampling " << options.light_samples << " of "
+             << lightTree.size() << " lights per shading point" << endl;
 
     if (mode == 0) {
         cout << "Rendering without acceleration" << endl;
@@ -415,38 +1167,81 @@ void Camera::render(Array2D <Rgba> &pixels, const vector<Surface *> &surfaces,
     ProgressBar progress = ProgressBar();
     progress.start();
 
-    for (int i = 0; i < this->ph; i++) {
-        for (int j = 0; j < this->pw; j++) {
-            RGB shade(0, 0, 0);
-
-            for (int p = 0; p < p_strata; p++) {
-                for (int q = 0; q < p_strata; q++) {
-                    Point px_sample;
-
-                    px_sample = this->getPixelSample(j, i, w, h, p, q,
-                                                     p_strata);
+    /* Every run mode has a renderer compiled for it, picked once here */
+    if (mode == 0)
+        renderPixels<0>(pixels, materials, plights, slights, lightTree,
+                        ambient, surfaceTree, options, w, h, p_samples,
+                        sample_spread, predictor, progress, stats,
+                        total_samples);
+    else if (mode == 1)
+        renderPixels<1>(pixels, materials, plights, slights, lightTree,
+                        ambient, surfaceTree, options, w, h, p_samples,
+                        sample_spread, predictor, progress, stats,
+                        total_samples);
+    else
+        renderPixels<-1>(pixels, materials, plights, slights, lightTree,
+                         ambient, surfaceTree, options, w, h, p_samples,
+                         sample_spread, predictor, progress, stats,
+                         total_samples);
 
-                    // TODO: should this ray originate from px_sample or eye?
-                    Ray view_ray(this->eye, px_sample.sub(this->eye).norm());
-
-                    shade.add(getShadeAlongRay(view_ray, plights, slights,
-                                               ambient, surfaceTree,
-                                               RECURSIVE_LIMIT, -1, mode,
-                                               s_strata));
-                }
-            }
-
-            float avg_factor = 1.0f / (p_strata * p_strata);
-            shade = shade.times(avg_factor);
-
-            Rgba &px = pixels[i][j];
-            px.r = shade.r;
-            px.g = shade.g;
-            px.b = shade.b;
-            px.a = 1;
-
-            progress.log((i + 1) * (j + 1), total_pixels);
-        }
-    }
     progress.done();
+
+    if (adaptive)
+        cout << "Primary samples per pixel: "
+             << (float) total_samples / total_pixels << endl;
+
+    if (predictor.searches > 0)
+        cout << "Primary hits predicted: "
+             << 100.0f * predictor.predicted / predictor.searches << "%"
+             << endl;
+
+    if (stats.tiles > 0)
+        cout << "Tiles: " << stats.tiles << " (" << stats.tiles_missed
+             << " missed the scene, the rest entered the BVH "
+             << (float) stats.entry_depth / (stats.tiles - stats.tiles_missed)
+             << " levels down on average)" << endl;
+
+    if (stats.raster_threads > 0)
+        cout << "Visibility buffer: " << stats.raster_primitives
+             << " primitives rasterized on " << stats.raster_threads
+             << " threads in " << stats.raster_time << "s, "
+             << stats.raster_traced << " samples traced" << endl;
+
+    if (stats.primary_rays > 0)
+        cout << "Primary rays: " << stats.primary_rays << " ("
+             << (float) stats.primary_nodes_visited / stats.primary_rays
+             << " BVH nodes visited per ray, "
+             << (float) stats.primary_time / CLOCKS_PER_SEC << "s to trace)"
+             << endl;
+
+    if (stats.reflected_rays > 0)
+        cout << "Reflected rays: " << stats.reflected_rays << " ("
+             << (float) stats.nodes_visited / stats.reflected_rays
+             << " BVH nodes visited per ray, "
+             << (float) stats.time / CLOCKS_PER_SEC << "s to trace)" << endl;
 }
+
+/* The searches the stages of the wavefront renderer (Wavefront.cc) run */
+template Hit Camera::getClosestSurface<-1>(const BVHTree &, const Ray &,
+                                           HitPredictor *,
+                                           const BVHNode *) const;
+template Hit Camera::getClosestSurface<0>(const BVHTree &, const Ray &,
+                                          HitPredictor *,
+                                          const BVHNode *) const;
+template Hit Camera::getClosestSurface<1>(const BVHTree &, const Ray &,
+                                          HitPredictor *,
+                                          const BVHNode *) const;
+
+template void Camera::resolveHit<-1>(const BVHTree &, const Ray &,
+                                     Hit &) const;
+template void Camera::resolveHit<0>(const BVHTree &, const Ray &,
+                                    Hit &) const;
+template void Camera::resolveHit<1>(const BVHTree &, const Ray &,
+                                    Hit &) const;
+
+template bool Camera::isIntercepted<-1>(const BVHTree &, const Ray &,
+                                        float) const;
+template bool Camera::isIntercepted<0>(const BVHTree &, const Ray &,
+                                       float) const;
+template bool Camera::isIntercepted<1>(const BVHTree &, const Ray &,
+                                       float) const;
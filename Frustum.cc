@@ -0,0 +1,104 @@
+/**
+ * @file    Frustum.cc
+ * @author  agent
+ * @date    10/19/26
+ * @brief   Holds the frusta used to cull bounding boxes for bundles of rays.
+ */
+
+#include <math.h>
+#include "include/Frustum.h"
+
+/*
+ * Slack given to the frustum so that rounding never culls a box which a ray
+ * at the very edge of the bundle only grazes.
+ */
+static const float FRUSTUM_EPSILON = 1e-3f;
+
+/**
+ * An unbounded frustum, which culls nothing.
+ */
+Frustum::Frustum() {
+    this->num_planes = 0;
+    this->lo = Point(-INFINITY, -INFINITY, -INFINITY);
+    this->hi = Point(INFINITY, INFINITY, INFINITY);
+}
+
+/**
+ * @brief encloses the rays through the given apex and base.
+ *
+ * @param apex    - the point all rays pass through.
+ * @param corners - the corners of the base, in order around it, such as the
+ *                  corners of an area light.
+ * @param capped  - true if the rays end at the apex and the base (shadow
+ *                  rays), false if they go on past the base (primary rays
+ *                  through the image plane).
+ *
+ * @details A side whose plane is degenerate (the apex in the plane of the
+ * base) is left out, which only makes the frustum looser.
+ */
+Frustum::Frustum(const Point &apex, const Point corners[4], bool capped) {
+    Vector centroid;
+
+    this->apex = apex;
+    this->num_planes = 0;
+    this->lo = Point(-INFINITY, -INFINITY, -INFINITY);
+    this->hi = Point(INFINITY, INFINITY, INFINITY);
+
+    if (capped)
+        this->lo = this->hi = apex;
+
+    for (int c = 0; c < 4; c++) {
+        centroid.plusEq(corners[c].sub(apex).times(0.25f));
+
+        if (!capped)
+            continue;
+
+        lo = Point(fminf(lo.x, corners[c].x), fminf(lo.y, corners[c].y),
+                   fminf(lo.z, corners[c].z));
+        hi = Point(fmaxf(hi.x, corners[c].x), fmaxf(hi.y, corners[c].y),
+                   fmaxf(hi.z, corners[c].z));
+    }
+
+    for (int c = 0; c < 4; c++) {
+        Vector n = corners[c].sub(apex).cross(corners[(c + 1) % 4].sub(apex));
+        float mag = n.mag();
+
+        if (mag == 0)
+            continue;
+
+        /* Orienting the plane so that the inside of the frustum is negative */
+        n = n.times((n.dot(centroid) > 0 ? -1 : 1) / mag);
+        planes[num_planes++] = n;
+    }
+}
+
+/**
+ * @name misses
+ * @brief determines if the bounding box lies entirely outside the frustum.
+ *
+ * @details The box is outside if it doesn't overlap the bounds of the
+ * frustum, or if its corner nearest the inside of a side plane is still
+ * outside that plane. The test is conservative: a box reported as missed is
+ * missed by every ray within the frustum, but not the other way around.
+ */
+bool Frustum::misses(const BoundingBox &box) const {
+    if (box.x_min > hi.x + FRUSTUM_EPSILON ||
+        box.x_max < lo.x - FRUSTUM_EPSILON ||
+        box.y_min > hi.y + FRUSTUM_EPSILON ||
+        box.y_max < lo.y - FRUSTUM_EPSILON ||
+        box.z_min > hi.z + FRUSTUM_EPSILON ||
+        box.z_max < lo.z - FRUSTUM_EPSILON)
+        return true;
+
+    for (int p = 0; p < num_planes; p++) {
+        const Vector &n = planes[p];
+        Point nearest(n.i > 0 ? box.x_min : box.x_max,
+                      n.j > 0 ? box.y_min : box.y_max,
+                      n.k > 0 ? box.z_min : box.z_max);
+
+        if (n.dot(nearest.sub(apex)) > FRUSTUM_EPSILON)
+            return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,364 @@
+/**
+ * @file    Kernels.cc
+ * @author  agent
+ * @date    10/19/26
+ * @brief   Holds the data-parallel loops of the renderer, compiled for each
+ *          instruction set they can run in, and picks the set to use.
+ */
+
+/*
+ * Wider instruction sets can fuse a multiply and an add into one operation,
+ * which rounds once instead of twice. Kept apart as written, so that every
+ * set gives the same result to the bit, whichever compiler builds it.
+ */
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#pragma clang fp contract(off)
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+#include <math.h>
+#include <cstring>
+#include "include/Kernels.h"
+#include "include/FastMath.h"
+
+using namespace std;
+
+/*
+ * The bodies of the kernels are written once, and inlined into a function
+ * per instruction set which the compiler vectorizes for that set.
+ */
+#define KERNEL static inline __attribute__((always_inline))
+
+/**
+ * @brief a if the sign is set, b otherwise.
+ *
+ * @details Picked on the bits, with a mask of all 1s or 0s: the compiler
+ * turns a select feeding a multiply into a branch, which keeps the loop out
+ * of vector registers.
+ */
+KERNEL float pick(int sign, float a, float b) {
+    unsigned int a_bits, b_bits;
+    memcpy(&a_bits, &a, sizeof(a_bits));
+    memcpy(&b_bits, &b, sizeof(b_bits));
+
+    unsigned int mask = -(unsigned int) (sign != 0);
+    unsigned int bits = (a_bits & mask) | (b_bits & ~mask);
+
+    float result;
+    memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+/**
+ * @see RayPacket::intersectBox and BoundingBox::getIntersection, whose
+ * arithmetic this is.
+ */
+KERNEL unsigned int intersectBoxBody(const RayLanes &lanes,
+                                     const BoundingBox &box, float *t_hits) {
+    int hits[RAY_PACKET_SIZE];
+
+    for (int r = 0; r < RAY_PACKET_SIZE; r++) {
+        float t_lo = lanes.t_min[r];
+        float t_hi = lanes.t_max[r];
+        float t_near, t_far;
+
+        t_near = (pick(lanes.sx[r], box.x_max, box.x_min) - lanes.ox[r]) *
+                 lanes.ix[r];
+        t_far = (pick(lanes.sx[r], box.x_min, box.x_max) - lanes.ox[r]) *
+                lanes.ix[r];
+        t_lo = (t_near > t_lo) ? t_near : t_lo;
+        t_hi = (t_far < t_hi) ? t_far : t_hi;
+
+        t_near = (pick(lanes.sy[r], box.y_max, box.y_min) - lanes.oy[r]) *
+                 lanes.iy[r];
+        t_far = (pick(lanes.sy[r], box.y_min, box.y_max) - lanes.oy[r]) *
+                lanes.iy[r];
+        t_lo = (t_near > t_lo) ? t_near : t_lo;
+        t_hi = (t_far < t_hi) ? t_far : t_hi;
+
+        t_near = (pick(lanes.sz[r], box.z_max, box.z_min) - lanes.oz[r]) *
+                 lanes.iz[r];
+        t_far = (pick(lanes.sz[r], box.z_min, box.z_max) - lanes.oz[r]) *
+                lanes.iz[r];
+        t_lo = (t_near > t_lo) ? t_near : t_lo;
+        t_hi = (t_far < t_hi) ? t_far : t_hi;
+
+        hits[r] = !(t_lo > t_hi);
+        t_hits[r] = t_lo;
+    }
+
+    unsigned int mask = 0;
+    for (int r = 0; r < RAY_PACKET_SIZE; r++)
+        mask |= (unsigned int) hits[r] << r;
+
+    return mask;
+}
+
+/**
+ * @see intersectBoxBody; the distances to the slab planes are the same for
+ * all rays, which only scale them by their reciprocal direction.
+ */
+KERNEL unsigned int intersectBoxFromBody(const RayLanes &lanes,
+                                         const float near[3],
+                                         const float far[3],
+                                         float *t_hits) {
+    int hits[RAY_PACKET_SIZE];
+
+    for (int r = 0; r < RAY_PACKET_SIZE; r++) {
+        float t_lo = lanes.t_min[r];
+        float t_hi = lanes.t_max[r];
+        float t_near, t_far;
+
+        t_near = near[0] * lanes.ix[r];
+        t_far = far[0] * lanes.ix[r];
+        t_lo = (t_near > t_lo) ? t_near : t_lo;
+        t_hi = (t_far < t_hi) ? t_far : t_hi;
+
+        t_near = near[1] * lanes.iy[r];
+        t_far = far[1] * lanes.iy[r];
+        t_lo = (t_near > t_lo) ? t_near : t_lo;
+        t_hi = (t_far < t_hi) ? t_far : t_hi;
+
+        t_near = near[2] * lanes.iz[r];
+        t_far = far[2] * lanes.iz[r];
+        t_lo = (t_near > t_lo) ? t_near : t_lo;
+        t_hi = (t_far < t_hi) ? t_far : t_hi;
+
+        hits[r] = !(t_lo > t_hi);
+        t_hits[r] = t_lo;
+    }
+
+    unsigned int mask = 0;
+    for (int r = 0; r < RAY_PACKET_SIZE; r++)
+        mask |= (unsigned int) hits[r] << r;
+
+    return mask;
+}
+
+/**
+ * @details The shading model (Material::phongShading, step for step) is
+ * evaluated in loops without branches or calls, but for powf. With the
+ * exact pow the result is the same to the bit as shading from one light at
+ * a time.
+ *
+ * @see Camera::diffuseFromPointLights
+ */
+KERNEL void shadePointLightsBody(const PointLightArray &lights, size_t first,
+                                 const Point &p, const Vector &n,
+                                 const Vector &v, const RGB &diffuse,
+                                 const RGB &specular, float phong,
+                                 bool has_specular, bool fast_pow,
+                                 PointLightBlock &block) {
+    float d2[LIGHT_LANES], cos_i[LIGHT_LANES], cos_h[LIGHT_LANES];
+    float highlight[LIGHT_LANES];
+
+    const float *x = &lights.x[first];
+    const float *y = &lights.y[first];
+    const float *z = &lights.z[first];
+
+    /* Falloff, diffuse factor and the cosine of the highlight */
+    for (int l = 0; l < LIGHT_LANES; l++) {
+        float dx = p.x - x[l];
+        float dy = p.y - y[l];
+        float dz = p.z - z[l];
+        float dist2 = dx * dx + dy * dy + dz * dz;
+        float mag = sqrtf(dist2);
+
+        /* Vector to the light, the light ray reversed */
+        block.ix[l] = -(dx / mag);
+        block.iy[l] = -(dy / mag);
+        block.iz[l] = -(dz / mag);
+
+        /* As fmaxf(1, d2) and fmaxf(0, cos), but in vector instructions */
+        d2[l] = (dist2 > 1) ? dist2 : 1;
+
+        float cos = n.i * block.ix[l] + n.j * block.iy[l] +
+                    n.k * block.iz[l];
+        cos_i[l] = (cos > 0) ? cos : 0;
+
+        float hx = v.i + block.ix[l];
+        float hy = v.j + block.iy[l];
+        float hz = v.k + block.iz[l];
+        float h_mag = sqrtf(hx * hx + hy * hy + hz * hz);
+
+        cos = n.i * (hx / h_mag) + n.j * (hy / h_mag) + n.k * (hz / h_mag);
+        cos_h[l] = (cos > 0) ? cos : 0;
+    }
+
+    if (!has_specular) {
+        for (int l = 0; l < LIGHT_LANES; l++)
+            highlight[l] = 0;
+    } else if (fast_pow) {
+        for (int l = 0; l < LIGHT_LANES; l++)
+            highlight[l] = fastPow(cos_h[l], phong);
+    } else {
+        for (int l = 0; l < LIGHT_LANES; l++)
+            highlight[l] = powf(cos_h[l], phong);
+    }
+
+    for (int l = 0; l < LIGHT_LANES; l++) {
+        block.r[l] = (diffuse.r * cos_i[l] + specular.r * highlight[l])
+                     * lights.r[first + l] / d2[l];
+        block.g[l] = (diffuse.g * cos_i[l] + specular.g * highlight[l])
+                     * lights.g[first + l] / d2[l];
+        block.b[l] = (diffuse.b * cos_i[l] + specular.b * highlight[l])
+                     * lights.b[first + l] / d2[l];
+    }
+}
+
+/**
+ * @details The pow of the highlight only runs for materials that have one,
+ * unless it is the approximate one, which is vectorized as well. The
+ * arithmetic is that of phongShading step for step, so with the exact pow
+ * the result is the same to the bit.
+ *
+ * @see Camera::shadeLightSamples
+ */
+KERNEL void shadeLightSamplesBody(LightSamples &s, int count, bool fast_pow) {
+    /* Falloff with distance and the diffuse factor */
+    for (int r = 0; r < count; r++) {
+        float d2 = s.dx[r] * s.dx[r] + s.dy[r] * s.dy[r] +
+                   s.dz[r] * s.dz[r];
+        float cos = s.nx[r] * s.ix[r] + s.ny[r] * s.iy[r] +
+                    s.nz[r] * s.iz[r];
+
+        /* As fmaxf(1, d2) and fmaxf(0, cos), but in vector instructions */
+        s.d2[r] = (d2 > 1) ? d2 : 1;
+        s.diffuse[r] = (cos > 0) ? cos : 0;
+    }
+
+    /* The highlight, around the normalized bisector of view and light */
+    if (fast_pow) {
+        for (int r = 0; r < count; r++) {
+            float mag = sqrtf(s.hx[r] * s.hx[r] + s.hy[r] * s.hy[r] +
+                              s.hz[r] * s.hz[r]);
+            float cos = s.nx[r] * (s.hx[r] / mag) +
+                        s.ny[r] * (s.hy[r] / mag) +
+                        s.nz[r] * (s.hz[r] / mag);
+
+            /* fastPow is 0 for cosines under 0, as fmaxf(0, cos) */
+            s.specular[r] = fastPow(cos, s.phong[r]);
+        }
+
+        for (int r = 0; r < count; r++)
+            if (!s.has_specular[r])
+                s.specular[r] = 0;
+    } else {
+        for (int r = 0; r < count; r++) {
+            if (!s.has_specular[r]) {
+                s.specular[r] = 0;
+                continue;
+            }
+
+            float mag = sqrtf(s.hx[r] * s.hx[r] + s.hy[r] * s.hy[r] +
+                              s.hz[r] * s.hz[r]);
+            float hx = s.hx[r] / mag;
+            float hy = s.hy[r] / mag;
+            float hz = s.hz[r] / mag;
+            float cos = s.nx[r] * hx + s.ny[r] * hy + s.nz[r] * hz;
+
+            s.specular[r] = powf(fmaxf(0, cos), s.phong[r]);
+        }
+    }
+
+    for (int r = 0; r < count; r++) {
+        s.r[r] = (s.diffuse_r[r] * s.diffuse[r] +
+                  s.specular_r[r] * s.specular[r]) * s.light_r[r] /
+                 s.d2[r];
+        s.g[r] = (s.diffuse_g[r] * s.diffuse[r] +
+                  s.specular_g[r] * s.specular[r]) * s.light_g[r] /
+                 s.d2[r];
+        s.b[r] = (s.diffuse_b[r] * s.diffuse[r] +
+                  s.specular_b[r] * s.specular[r]) * s.light_b[r] /
+                 s.d2[r];
+    }
+}
+
+/*
+ * Defines the kernels of one instruction set: a function per kernel into
+ * which its body is inlined, compiled with the given target attribute, and
+ * the Kernels pointing at them.
+ */
+#define DEFINE_KERNELS(isa, target)                                          \
+    target static unsigned int isa##IntersectBox(                            \
+            const RayLanes &lanes, const BoundingBox &box, float *t_hits) {  \
+        return intersectBoxBody(lanes, box, t_hits);                         \
+    }                                                                        \
+                                                                             \
+    target static unsigned int isa##IntersectBoxFrom(                        \
+            const RayLanes &lanes, const float *near, const float *far,      \
+            float *t_hits) {                                                 \
+        return intersectBoxFromBody(lanes, near, far, t_hits);               \
+    }                                                                        \
+                                                                             \
+    target static void isa##ShadePointLights(                                \
+            const PointLightArray &lights, size_t first, const Point &p,     \
+            const Vector &n, const Vector &v, const RGB &diffuse,            \
+            const RGB &specular, float phong, bool has_specular,             \
+            bool fast_pow, PointLightBlock &block) {                         \
+        shadePointLightsBody(lights, first, p, n, v, diffuse, specular,      \
+                             phong, has_specular, fast_pow, block);          \
+    }                                                                        \
+                                                                             \
+    target static void isa##ShadeLightSamples(LightSamples &s, int count,    \
+                                              bool fast_pow) {               \
+        shadeLightSamplesBody(s, count, fast_pow);                           \
+    }                                                                        \
+                                                                             \
+    static const Kernels isa##Kernels(#isa, isa##IntersectBox,               \
+                                      isa##IntersectBoxFrom,                 \
+                                      isa##ShadePointLights,                 \
+                                      isa##ShadeLightSamples);
+
+/* What the compiler targets by default, e.g. SSE2 on x86-64 */
+DEFINE_KERNELS(generic, )
+
+/* Wider sets only on x86, where the processor is asked for them */
+#if defined(__x86_64__) || defined(__i386__)
+#define HAS_X86_KERNELS
+
+DEFINE_KERNELS(avx2, __attribute__((target("avx2"))))
+DEFINE_KERNELS(avx512,
+               __attribute__((target("avx512f,prefer-vector-width=512"))))
+#endif
+
+const Kernels *Kernels::active = Kernels::best();
+
+/**
+ * @name    get
+ * @brief   Looks up a set of kernels by name.
+ *
+ * @param name - one of generic, avx2 or avx512.
+ * @returns    - the set, nullptr for an unknown name or one the processor
+ *               does not support.
+ */
+const Kernels *Kernels::get(const string &name) {
+    if (name == "generic") return &genericKernels;
+
+#ifdef HAS_X86_KERNELS
+    __builtin_cpu_init();
+
+    if (name == "avx2" && __builtin_cpu_supports("avx2"))
+        return &avx2Kernels;
+    if (name == "avx512" && __builtin_cpu_supports("avx512f"))
+        return &avx512Kernels;
+#endif
+    return nullptr;
+}
+
+/**
+ * @name    best
+ * @returns the set of kernels for the widest instruction set the processor
+ *          supports.
+ */
+const Kernels *Kernels::best() {
+    const char *names[] = {"avx512", "avx2"};
+
+    for (const char *name : names)
+        if (const Kernels *kernels = get(name))
+            return kernels;
+
+    return get("generic");
+}
@@ -0,0 +1,293 @@
+/**
+ * @file    LightTree.cc
+ * @author  agent
+ * @date    10/19/26
+ * @brief   Holds all constructors and members of the LightTree class.
+ */
+
+#include <algorithm>
+#include <limits>
+#include <math.h>
+#include "include/LightTree.h"
+
+using namespace std;
+
+LightEntry::LightEntry(const PointLight *light) {
+    this->plight = light;
+    this->slight = nullptr;
+    this->lo = this->hi = light->position;
+    this->power = light->color.r + light->color.g + light->color.b;
+    this->radius = numeric_limits<float>::infinity();
+}
+
+LightEntry::LightEntry(const SquareLight *light) {
+    this->plight = nullptr;
+    this->slight = light;
+
+    /* Half the diagonal extent of the square along each axis */
+    float half = light->len / 2;
+    float dx = half * (fabsf(light->u.i) + fabsf(light->v.i));
+    float dy = half * (fabsf(light->u.j) + fabsf(light->v.j));
+    float dz = half * (fabsf(light->u.k) + fabsf(light->v.k));
+
+    this->lo = Point(light->center.x - dx, light->center.y - dy,
+                     light->center.z - dz);
+    this->hi = Point(light->center.x + dx, light->center.y + dy,
+                     light->center.z + dz);
+    this->power = light->color.r + light->color.g + light->color.b;
+    this->radius = numeric_limits<float>::infinity();
+}
+
+LightTree::LightTree(const vector<PointLight *> &plights,
+                     const vector<SquareLight *> &slights) {
+    for (PointLight *light : plights)
+        lights.push_back(LightEntry(light));
+
+    for (SquareLight *light : slights)
+        lights.push_back(LightEntry(light));
+
+    this->root = lights.empty()
+                 ? nullptr : _makeLightTree(0, (int) lights.size() - 1);
+
+    if (this->root != nullptr)
+        _setInfluence(this->root);
+}
+
+LightTree::~LightTree() {
+    delete this->root;
+}
+
+int LightTree::size() const {
+    return (int) lights.size();
+}
+
+const LightEntry &LightTree::at(int index) const {
+    return lights[index];
+}
+
+/**
+ * @name    _makeLightTree
+ * @private used in LightTree class only
+ * @brief   Builds the tree over the lights from start to end (inclusive).
+ *
+ * @details Lights are split at the median along the longest axis of their
+ * bounds, similar to how the BVHTree splits surfaces. Every node records the
+ * bounds and the total power of the lights below it.
+ */
+LightTreeNode *LightTree::_makeLightTree(int start, int end) {
+    LightTreeNode *node = new LightTreeNode();
+
+    node->lo = lights[start].lo;
+    node->hi = lights[start].hi;
+
+    for (int i = start; i <= end; i++) {
+        node->lo = Point(fminf(node->lo.x, lights[i].lo.x),
+                         fminf(node->lo.y, lights[i].lo.y),
+                         fminf(node->lo.z, lights[i].lo.z));
+        node->hi = Point(fmaxf(node->hi.x, lights[i].hi.x),
+                         fmaxf(node->hi.y, lights[i].hi.y),
+                         fmaxf(node->hi.z, lights[i].hi.z));
+        node->power += lights[i].power;
+    }
+
+    if (start == end) {
+        node->light_idx = start;
+        return node;
+    }
+
+    Vector extent = node->hi.sub(node->lo);
+    int axis = (extent.i >= extent.j && extent.i >= extent.k)
+               ? 0 : (extent.j >= extent.k ? 1 : 2);
+
+    auto center = [axis](const LightEntry &light) -> float {
+        if (axis == 0) return light.lo.x + light.hi.x;
+        if (axis == 1) return light.lo.y + light.hi.y;
+        return light.lo.z + light.hi.z;
+    };
+
+    int mid = start + (end - start) / 2;
+
+    nth_element(lights.begin() + start,
+                lights.begin() + mid,
+                lights.begin() + end + 1,
+                [&center](const LightEntry &a, const LightEntry &b) -> bool {
+                    return center(a) < center(b);
+                });
+
+    node->left = _makeLightTree(start, mid);
+    node->right = _makeLightTree(mid + 1, end);
+
+    return node;
+}
+
+/**
+ * @name    importance
+ * @brief   Estimates the contribution of all lights under a node at a point.
+ *
+ * @details The total power of the node falls off with the squared distance
+ * from the point to the center of the node. So that nearby or enclosing
+ * clusters don't blow up, the distance is never taken to be less than half
+ * the diagonal of the node (nor less than 1, matching phongShading).
+ */
+float LightTree::importance(const LightTreeNode *node, const Point &p) const {
+    Point center((node->lo.x + node->hi.x) / 2,
+                 (node->lo.y + node->hi.y) / 2,
+                 (node->lo.z + node->hi.z) / 2);
+
+    float radius2 = node->lo.distance2(node->hi) / 4;
+    float d2 = fmaxf(1, fmaxf(radius2, p.distance2(center)));
+
+    return node->power / d2;
+}
+
+/**
+ * @name    sample
+ * @brief   Picks one light for shading the given point.
+ *
+ * @param p   - the point being shaded.
+ * @param pdf - receives the probability with which the light was picked.
+ * @returns   - the index of the picked light, -1 if there are no lights.
+ *
+ * @details Starting from the root, one of the two children is chosen at
+ * random in proportion to their importance at p until a single light is
+ * reached. The probability of the light is the product of the probabilities
+ * of all choices made on the way.
+ */
+int LightTree::sample(const Point &p, float &pdf) const {
+    const LightTreeNode *node = this->root;
+    pdf = 1;
+
+    if (node == nullptr)
+        return -1;
+
+    while (node->light_idx == -1) {
+        float i_left = importance(node->left, p);
+        float i_right = importance(node->right, p);
+        float p_left = (i_left + i_right > 0)
+                       ? i_left / (i_left + i_right) : 0.5f;
+
+        if (rand() / (RAND_MAX + 1.0) < p_left) {
+            node = node->left;
+            pdf *= p_left;
+        } else {
+            node = node->right;
+            pdf *= 1 - p_left;
+        }
+    }
+    return node->light_idx;
+}
+
+/**
+ * @name    setCutoff
+ * @brief   Bounds the region each light can visibly contribute to.
+ *
+ * @param cutoff          - contributions below this are dropped.
+ * @param max_reflectance - an upper bound on the diffuse plus specular
+ *                          coefficients of any material in the scene.
+ *
+ * @details A light of color c shades a point at distance d with at most
+ * max_reflectance * c / d^2 in any channel (phongShading never lets the cos
+ * factors exceed 1, and square lights are further dimmed by their own cos).
+ * Solving for d gives the radius beyond which the light can be skipped.
+ */
+void LightTree::setCutoff(float cutoff, float max_reflectance) {
+    for (LightEntry &light : lights) {
+        const RGB &c = (light.plight != nullptr)
+                       ? light.plight->color : light.slight->color;
+
+        light.radius = (cutoff > 0)
+                       ? sqrtf(max_reflectance * c.maxComponent() / cutoff)
+                       : numeric_limits<float>::infinity();
+    }
+
+    if (this->root != nullptr)
+        _setInfluence(this->root);
+}
+
+/**
+ * @name    _setInfluence
+ * @private used in LightTree class only
+ * @brief   Recomputes the influence bounds of the node and its children from
+ *          the radii of their lights.
+ */
+void LightTree::_setInfluence(LightTreeNode *node) {
+    if (node->light_idx != -1) {
+        const LightEntry &light = lights[node->light_idx];
+        float r = light.radius;
+
+        node->influence_lo = Point(light.lo.x - r, light.lo.y - r,
+                                   light.lo.z - r);
+        node->influence_hi = Point(light.hi.x + r, light.hi.y + r,
+                                   light.hi.z + r);
+        return;
+    }
+
+    _setInfluence(node->left);
+    _setInfluence(node->right);
+
+    const Point &l1 = node->left->influence_lo, &l2 = node->right->influence_lo;
+    const Point &h1 = node->left->influence_hi, &h2 = node->right->influence_hi;
+
+    node->influence_lo = Point(fminf(l1.x, l2.x), fminf(l1.y, l2.y),
+                               fminf(l1.z, l2.z));
+    node->influence_hi = Point(fmaxf(h1.x, h2.x), fmaxf(h1.y, h2.y),
+                               fmaxf(h1.z, h2.z));
+}
+
+/**
+ * @name    influences
+ * @brief   Checks whether a light may contribute more than the cutoff at a
+ *          point, i.e. whether the point lies within its influence radius.
+ */
+bool LightTree::influences(int index, const Point &p) const {
+    const LightEntry &light = lights[index];
+
+    /* Squared distance from the point to the bounds of the light */
+    float dx = fmaxf(0, fmaxf(light.lo.x - p.x, p.x - light.hi.x));
+    float dy = fmaxf(0, fmaxf(light.lo.y - p.y, p.y - light.hi.y));
+    float dz = fmaxf(0, fmaxf(light.lo.z - p.z, p.z - light.hi.z));
+
+    return dx * dx + dy * dy + dz * dz <= light.radius * light.radius;
+}
+
+/**
+ * @name    getInfluencingLights
+ * @brief   Finds all lights that may contribute more than the cutoff at a
+ *          point.
+ *
+ * @param p   - the point being shaded.
+ * @param out - cleared and filled with the indices of the lights.
+ *
+ * @details Subtrees whose influence bounds don't contain the point are
+ * skipped as a whole.
+ */
+void LightTree::getInfluencingLights(const Point &p, vector<int> &out) const {
+    out.clear();
+
+    if (this->root == nullptr)
+        return;
+
+    /* Median splits keep the tree shallow enough for a fixed stack */
+    const LightTreeNode *stack[64];
+    int top = 0;
+
+    stack[top++] = this->root;
+
+    while (top > 0) {
+        const LightTreeNode *node = stack[--top];
+
+        if (p.x < node->influence_lo.x || p.x > node->influence_hi.x ||
+            p.y < node->influence_lo.y || p.y > node->influence_hi.y ||
+            p.z < node->influence_lo.z || p.z > node->influence_hi.z)
+            continue;
+
+        if (node->light_idx != -1) {
+            if (influences(node->light_idx, p))
+                out.push_back(node->light_idx);
+            continue;
+        }
+
+        stack[top++] = node->right;
+        stack[top++] = node->left;
+    }
+}
@@ -0,0 +1,85 @@
+/**
+ * @file    Material.cc
+ * @author  agent
+ * @date    10/19/26
+ * @brief   Holds the shading model of the Material class.
+ */
+
+#include <math.h>
+#include "include/Material.h"
+
+
+/**
+ * @name    phongShading
+ * @brief   Determines the shade of the material at a given point.
+ *
+ * @param light - the light source used for shading.
+ * @param light_ray - a ray originating from the light source to the surface.
+ * @param view_ray - a ray originating from the camera to the surface.
+ * @param hit - the resolved hit record of the view ray on a surface made of
+ *              this material; its normal is expected to already face the
+ *              viewer.
+ * @returns - an RGB object representing the shade on the surface determined
+            using phong's shading model.
+ */
+RGB Material::phongShading(const RGB &light_color,
+                           const Ray &light_ray,
+                           const Ray &view_ray,
+                           const Hit &hit) const {
+
+    float r, g, b, d2, diffuse_factor, specular_factor;
+    Vector v, I, bisector;
+    RGB material_diffuse, material_specular;
+    bool has_specular;
+
+    /*
+     * TODO: rethink if necessary to do it in this particular way.
+     * If the light hits the back side of the surface then simply give it a
+     * unique diffuse and specular values. The normal in the hit record has
+     * already been inverted in that case.
+     */
+    if (hit.front_faced) {
+        material_diffuse = diffuse;
+        material_specular = specular;
+        has_specular = !specular_free;
+    } else {
+        material_diffuse = RGB(1, 1, 0);
+        material_specular = RGB(0, 0, 0);
+        has_specular = false;
+    }
+
+    /*
+     * Distance of light from the point of intersection squared.
+     * Note: distance cannot be less than 1 else intensity values will get
+     * scaled up which shouldn't happen.
+     */
+    d2 = fmaxf(1, light_ray.origin.distance2(hit.point));
+
+    /* Vector to the light source */
+    I = -light_ray.direction;
+
+    diffuse_factor = fmaxf(0, hit.normal.dot(I));
+    specular_factor = 0;
+
+    /* The highlight (and its pow) is skipped for specular-free materials */
+    if (has_specular) {
+        /* Vector to the viewer */
+        v = -view_ray.direction;
+
+        /* Vector bisecting the view vector and light vector */
+        bisector = v.plus(I).norm();
+
+        specular_factor = powf(fmaxf(0, hit.normal.dot(bisector)), phong);
+    }
+
+    r = (material_diffuse.r * diffuse_factor
+         + material_specular.r * specular_factor) * light_color.r / d2;
+
+    g = (material_diffuse.g * diffuse_factor
+         + material_specular.g * specular_factor) * light_color.g / d2;
+
+    b = (material_diffuse.b * diffuse_factor
+         + material_specular.b * specular_factor) * light_color.b / d2;
+
+    return RGB(r, g, b);
+}
@@ -0,0 +1,309 @@
+/**
+ * @file    Mesh.cc
+ * @author  agent
+ * @date    10/19/26
+ * @brief   Holds all constructors and members of the Mesh class.
+ */
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <set>
+#include <tuple>
+#include "include/Mesh.h"
+
+using namespace std;
+
+Mesh::Mesh(float lod_threshold) {
+    this->lod_threshold = lod_threshold;
+    this->bbox = nullptr;
+}
+
+Mesh::~Mesh() {
+    for (BVHTree *tree : trees)
+        delete tree;
+
+    for (vector<Surface *> *level : levels) {
+        for (Surface *surface : *level)
+            delete surface;
+        delete level;
+    }
+}
+
+/**
+ * @name    addLevel
+ * @brief   Appends the next (coarser) level of detail to the mesh.
+ *
+ * @param surfaces    - the surfaces making up this level; the mesh takes
+ *                      ownership of them.
+ * @param edge_length - the mean edge length of this level.
+ */
+void Mesh::addLevel(const vector<Surface *> &surfaces, float edge_length) {
+    levels.push_back(new vector<Surface *>(surfaces));
+    edge_lengths.push_back(edge_length);
+}
+
+/**
+ * @name    build
+ * @brief   Constructs the BVHTree of every level and the bounding box of the
+ *          whole mesh. Must be called once all levels have been added.
+ */
+void Mesh::build() {
+    vector<BoundingBox *> bboxes;
+
+    for (vector<Surface *> *level : levels)
+        for (Surface *surface : *level)
+            bboxes.push_back(surface->bbox);
+
+    this->bbox = BoundingBox::groupBoundingBoxes(bboxes, 0,
+                                                 (int) bboxes.size() - 1);
+
+    for (vector<Surface *> *level : levels) {
+        BVHTree *tree = new BVHTree(level);
+        tree->makeBVHTree(false);
+        trees.push_back(tree);
+    }
+}
+
+int Mesh::levelCount() const {
+    return (int) levels.size();
+}
+
+int Mesh::levelSize(int level) const {
+    return (int) levels[level]->size();
+}
+
+/**
+ * @name    selectLevel
+ * @brief   Picks the level of detail to trace the given ray against.
+ *
+ * @details The footprint of the ray is measured where it enters the bounding
+ * box of the mesh. The coarsest level whose mean edge length is within
+ * lod_threshold footprints is chosen, falling back to the full resolution
+ * mesh. Rays without a cone always see the full resolution mesh.
+ */
+int Mesh::selectLevel(const Ray &ray) const {
+    if (lod_threshold <= 0 || levels.size() == 1)
+        return 0;
+
+    float t_entry = this->bbox->getIntersection(ray);
+    if (t_entry == -1)
+        return 0;
+
+    float footprint = ray.getFootprint(t_entry) * lod_threshold;
+
+    for (int level = (int) levels.size() - 1; level > 0; level--) {
+        if (edge_lengths[level] <= footprint)
+            return level;
+    }
+    return 0;
+}
+
+float Mesh::getIntersection(const Ray &ray) const {
+    Hit hit;
+    return this->getIntersection(ray, hit);
+}
+
+/**
+ * @name    getIntersection
+ * @brief   Finds the closest primitive of the selected level of detail along
+ *          the ray.
+ *
+ * @param hit - holds the closest intersection found so far, beyond which
+ *              the search stops; receives the primitive that was hit along
+ *              with its surface co-ordinates.
+ * @returns   - the parameterized location of the intersection point on the
+ *              ray, -1 if the ray misses the mesh before hit.t.
+ */
+float Mesh::getIntersection(const Ray &ray, Hit &hit) const {
+    Hit closest = trees[selectLevel(ray)]->getClosestSurface<-1>(ray, hit.t);
+
+    if (closest.surface_idx == -1)
+        return -1;
+
+    hit.primitive = closest.primitive;
+    hit.u = closest.u;
+    hit.v = closest.v;
+    hit.geometric_normal = closest.geometric_normal;
+    hit.smooth = closest.smooth;
+
+    return closest.t;
+}
+
+/*
+ * A mesh has no normal of its own; the normal of the primitive that was hit
+ * should be used instead.
+ */
+Vector Mesh::getSurfaceNormal(const Point &p) const {
+    return this->bbox->getSurfaceNormal(p);
+}
+
+Vector Mesh::getSurfaceNormal(const Hit &hit) const {
+    return hit.primitive->getSurfaceNormal(hit);
+}
+
+bool Mesh::isFrontFacedTo(const Ray &ray) const {
+    return true;
+}
+
+/**
+ * @name    intercepts
+ * @brief   Determines if any primitive of the selected level of detail
+ *          intercepts the ray before it gets to t_max, stopping at the
+ *          first one found.
+ */
+bool Mesh::intercepts(const Ray &ray, float t_max) const {
+    return trees[selectLevel(ray)]->isIntercepted<-1>(ray, t_max);
+}
+
+/**
+ * @name    meanEdgeLength
+ * @brief   Computes the mean length of the triangle edges of a mesh given in
+ *          the format of read_wavefront_file.
+ */
+float Mesh::meanEdgeLength(const vector<int> &tris,
+                           const vector<float> &verts) {
+    double total = 0;
+
+    for (unsigned int i = 0; i < tris.size(); i++) {
+        int a = tris[i];
+        int b = tris[(i % 3 == 2) ? i - 2 : i + 1];
+
+        Point pa(verts[3 * a], verts[3 * a + 1], verts[3 * a + 2]);
+        Point pb(verts[3 * b], verts[3 * b + 1], verts[3 * b + 2]);
+
+        total += sqrtf(pa.distance2(pb));
+    }
+
+    return tris.empty() ? 0 : (float) (total / tris.size());
+}
+
+/**
+ * @brief   Normal of the triangle (a, b, c) of a mesh in the format of
+ *          read_wavefront_file, scaled by twice its area.
+ */
+static Vector faceNormal(const vector<float> &verts, int a, int b, int c) {
+    Point pa(verts[3 * a], verts[3 * a + 1], verts[3 * a + 2]);
+    Point pb(verts[3 * b], verts[3 * b + 1], verts[3 * b + 2]);
+    Point pc(verts[3 * c], verts[3 * c + 1], verts[3 * c + 2]);
+
+    return pb.sub(pa).cross(pc.sub(pa));
+}
+
+/**
+ * @name    decimate
+ * @brief   Simplifies a mesh by clustering its vertices on a uniform grid.
+ *
+ * @param tris | @param verts - the mesh in the format of read_wavefront_file.
+ * @param cell      - edge length of a grid cell.
+ * @param out_tris | @param out_verts - receive the simplified mesh.
+ *
+ * @details All vertices falling in the same cell are collapsed into their
+ * mean. Triangles that lose an edge in the process (two of their vertices
+ * end up in the same cell) vanish, as do duplicate triangles. The winding of
+ * the surviving triangles is preserved, so triangles turned over by the
+ * clustering (their face normal points against the original one) are dropped
+ * as they would show their back face on the outside of the mesh. So are
+ * triangles over the same three cells wound both ways, e.g. the two sides of
+ * a thin part of the mesh collapsed into one sheet, as either one alone
+ * would show its back face from the other side.
+ */
+void Mesh::decimate(const vector<int> &tris, const vector<float> &verts,
+                    float cell,
+                    vector<int> &out_tris, vector<float> &out_verts) {
+    int n_verts = (int) verts.size() / 3;
+    float x0 = numeric_limits<float>::infinity(), y0 = x0, z0 = x0;
+
+    for (int i = 0; i < n_verts; i++) {
+        x0 = fminf(x0, verts[3 * i]);
+        y0 = fminf(y0, verts[3 * i + 1]);
+        z0 = fminf(z0, verts[3 * i + 2]);
+    }
+
+    map<tuple<int, int, int>, int> clusters;
+    vector<int> cluster_of((unsigned long) n_verts);
+    vector<int> cluster_size;
+
+    out_tris.clear();
+    out_verts.clear();
+
+    for (int i = 0; i < n_verts; i++) {
+        auto key = make_tuple((int) floorf((verts[3 * i] - x0) / cell),
+                              (int) floorf((verts[3 * i + 1] - y0) / cell),
+                              (int) floorf((verts[3 * i + 2] - z0) / cell));
+
+        auto it = clusters.find(key);
+        if (it == clusters.end()) {
+            it = clusters.insert(make_pair(key, (int) cluster_size.size()))
+                    .first;
+            cluster_size.push_back(0);
+            out_verts.push_back(0);
+            out_verts.push_back(0);
+            out_verts.push_back(0);
+        }
+
+        int c = it->second;
+        cluster_of[i] = c;
+        cluster_size[c]++;
+
+        for (int k = 0; k < 3; k++)
+            out_verts[3 * c + k] += verts[3 * i + k];
+    }
+
+    for (unsigned int c = 0; c < cluster_size.size(); c++) {
+        for (int k = 0; k < 3; k++)
+            out_verts[3 * c + k] /= cluster_size[c];
+    }
+
+    /*
+     * Sides on which each set of three clusters has triangles: 1 if wound
+     * as the sorted clusters are, 2 if wound the other way, 3 if both.
+     */
+    map<tuple<int, int, int>, int> sides;
+    vector<int> kept;
+
+    for (unsigned int i = 0; i < tris.size() / 3; i++) {
+        int a = cluster_of[tris[3 * i]];
+        int b = cluster_of[tris[3 * i + 1]];
+        int c = cluster_of[tris[3 * i + 2]];
+
+        if (a == b || b == c || c == a)
+            continue;
+
+        int corners[] = {a, b, c};
+        sort(corners, corners + 3);
+
+        bool sorted_winding = (a == corners[0] && b == corners[1]) ||
+                              (b == corners[0] && c == corners[1]) ||
+                              (c == corners[0] && a == corners[1]);
+
+        sides[make_tuple(corners[0], corners[1], corners[2])] |=
+                sorted_winding ? 1 : 2;
+
+        /* Turned over by the clustering */
+        if (faceNormal(out_verts, a, b, c)
+                    .dot(faceNormal(verts, tris[3 * i], tris[3 * i + 1],
+                                    tris[3 * i + 2])) <= 0)
+            continue;
+
+        kept.push_back(a);
+        kept.push_back(b);
+        kept.push_back(c);
+    }
+
+    set<tuple<int, int, int>> seen;
+
+    for (unsigned int i = 0; i < kept.size(); i += 3) {
+        int corners[] = {kept[i], kept[i + 1], kept[i + 2]};
+        sort(corners, corners + 3);
+
+        auto key = make_tuple(corners[0], corners[1], corners[2]);
+
+        /* A fold collapsed into a sheet, or a duplicate */
+        if (sides[key] == 3 || !seen.insert(key).second)
+            continue;
+
+        out_tris.insert(out_tris.end(), kept.begin() + i,
+                        kept.begin() + i + 3);
+    }
+}
@@ -6,9 +6,12 @@
 #include <fstream>
 #include <cstring>
 #include <sstream>
+#include <unordered_map>
 #include "include/Parser.h"
 #include "include/Sphere.h"
 #include "include/Triangle.h"
+#include "include/Quad.h"
+#include "include/Mesh.h"
 
 // this is called from the parseSceneFile function, which uses
 // it to get the float from the correspoding position on the line.
@@ -134,6 +137,217 @@ void read_wavefront_file(
     //   std::cout << "found this many tris, verts: " << tris.size () / 3.0 << "  " << verts.size () / 3.0 << std::endl;
 }
 
+/**
+ * @name    merge_triangle_pairs
+ * @brief   Finds pairs of triangles in a mesh that together make up a planar
+ *          parallelogram so that they can be replaced by a single quad.
+ *
+ * @param tris   - the triangles of the mesh as read by read_wavefront_file.
+ * @param verts  - the vertices of the mesh as read by read_wavefront_file.
+ * @param quads  - receives 4 vertex indices per merged quad, in
+ *                 counter-clockwise order starting at the corner p1 such that
+ *                 the 2nd and 4th vertices are p1 + e1 and p1 + e2.
+ * @param merged - receives for every triangle whether it is now part of a
+ *                 quad.
+ *
+ * @details Two triangles are merged only if they share an edge, traverse it
+ * in opposite directions (i.e. have the same winding), are coplanar and the
+ * resulting quad is a parallelogram. Triangles are visited in file order and
+ * greedily paired with the first neighbour that qualifies.
+ */
+void merge_triangle_pairs(const vector<int> &tris,
+                          const vector<float> &verts,
+                          vector<int> &quads,
+                          vector<bool> &merged) {
+    int n = (int) tris.size() / 3;
+
+    auto vertex = [&verts](int idx) -> Point {
+        return Point(verts[3 * idx], verts[3 * idx + 1], verts[3 * idx + 2]);
+    };
+
+    auto edgeKey = [](int a, int b) -> long long {
+        return ((long long) min(a, b) << 32) | (unsigned int) max(a, b);
+    };
+
+    quads.clear();
+    merged.assign((unsigned long) n, false);
+
+    /* Triangles sharing each (undirected) edge of the mesh */
+    unordered_map<long long, vector<int>> edges;
+    vector<Vector> face_normals((unsigned long) n);
+
+    for (int i = 0; i < n; i++) {
+        Point a = vertex(tris[3 * i]);
+        Point b = vertex(tris[3 * i + 1]);
+        Point c = vertex(tris[3 * i + 2]);
+
+        Vector N = b.sub(a).cross(c.sub(a));
+        face_normals[i] = N.equals(Vector(0, 0, 0)) ? N : N.norm();
+
+        for (int k = 0; k < 3; k++)
+            edges[edgeKey(tris[3 * i + k], tris[3 * i + (k + 1) % 3])]
+                    .push_back(i);
+    }
+
+    for (int i = 0; i < n; i++) {
+        if (merged[i] || face_normals[i].equals(Vector(0, 0, 0)))
+            continue;
+
+        for (int k = 0; k < 3 && !merged[i]; k++) {
+            /* Shared edge (x0 -> x1) of triangle i and its opposite vertex */
+            int x0 = tris[3 * i + k];
+            int x1 = tris[3 * i + (k + 1) % 3];
+            int x2 = tris[3 * i + (k + 2) % 3];
+
+            for (int j : edges[edgeKey(x0, x1)]) {
+                if (j == i || merged[j])
+                    continue;
+
+                /* Triangle j must traverse the edge as x1 -> x0 */
+                int y = -1;
+                for (int m = 0; m < 3; m++) {
+                    if (tris[3 * j + m] == x1 &&
+                        tris[3 * j + (m + 1) % 3] == x0)
+                        y = tris[3 * j + (m + 2) % 3];
+                }
+
+                if (y == -1 || face_normals[i].dot(face_normals[j]) < 0.9999f)
+                    continue;
+
+                /* Quad (x2, x0, y, x1) is a parallelogram iff diagonals
+                 * bisect each other */
+                Point q0 = vertex(x2), q1 = vertex(x0);
+                Point q2 = vertex(y), q3 = vertex(x1);
+
+                Vector gap = q0.sub(q1).plus(q2.sub(q3));
+                float scale = q0.distance2(q2) + q1.distance2(q3);
+
+                if (gap.dot(gap) > 1e-8f * scale)
+                    continue;
+
+                quads.push_back(x2);
+                quads.push_back(x0);
+                quads.push_back(y);
+                quads.push_back(x1);
+
+                merged[i] = merged[j] = true;
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * @name    build_mesh
+ * @brief   Turns a mesh read by read_wavefront_file into surfaces.
+ *
+ * @param tris | @param verts - the mesh in the format of read_wavefront_file.
+ * @param material - index of the material applied to every surface of the
+ *                   mesh.
+ * @param closed   - whether the mesh is closed, in which case its back faces
+ *                   can never be visible and are culled.
+ * @param surfaces - receives the surfaces making up the mesh.
+ *
+ * @details Vertex normals are computed by averaging the normals of all
+ * triangles sharing the vertex, and pairs of triangles that form planar
+ * parallelograms are merged into quads.
+ */
+void build_mesh(const vector<int> &tris,
+                const vector<float> &verts,
+                uint32_t material,
+                bool closed,
+                vector<Surface *> &surfaces) {
+    vector<Triangle *> triangles;
+
+    Vector vertex_normals[verts.size() / 3];
+    for (unsigned int i = 0; i < verts.size() / 3; i++)
+        vertex_normals[i] = Vector();
+
+    for (unsigned int i = 0; i < tris.size() / 3; i++) {
+        Triangle *triangle;
+        int v1, v2, v3;
+        float x1, y1, z1, x2, y2, z2, x3, y3, z3;
+
+        v1 = tris[3 * i];
+        v2 = tris[3 * i + 1];
+        v3 = tris[3 * i + 2];
+
+        x1 = verts[3 * v1];
+        y1 = verts[3 * v1 + 1];
+        z1 = verts[3 * v1 + 2];
+
+        x2 = verts[3 * v2];
+        y2 = verts[3 * v2 + 1];
+        z2 = verts[3 * v2 + 2];
+
+        x3 = verts[3 * v3];
+        y3 = verts[3 * v3 + 1];
+        z3 = verts[3 * v3 + 2];
+
+        triangle = new Triangle(x1, y1, z1, x2, y2, z2, x3, y3, z3);
+        triangle->setMaterial(material);
+
+        vertex_normals[v1].plusEq(triangle->normal);
+        vertex_normals[v2].plusEq(triangle->normal);
+        vertex_normals[v3].plusEq(triangle->normal);
+        triangles.push_back(triangle);
+    }
+
+    for (unsigned int i = 0; i < verts.size() / 3; i++) {
+        if (!vertex_normals[i].equals(Vector(0, 0, 0)))
+            vertex_normals[i] = vertex_normals[i].norm();
+    }
+
+    /*
+     * Replace pairs of triangles that form planar parallelograms with a
+     * single quad.
+     */
+    vector<int> quads;
+    vector<bool> merged;
+    merge_triangle_pairs(tris, verts, quads, merged);
+
+    for (unsigned int i = 0; i < quads.size() / 4; i++) {
+        int q[4];
+        for (int k = 0; k < 4; k++)
+            q[k] = quads[4 * i + k];
+
+        Quad *quad = new Quad(verts[3 * q[0]],
+                              verts[3 * q[0] + 1],
+                              verts[3 * q[0] + 2],
+                              verts[3 * q[1]],
+                              verts[3 * q[1] + 1],
+                              verts[3 * q[1] + 2],
+                              verts[3 * q[3]],
+                              verts[3 * q[3] + 1],
+                              verts[3 * q[3] + 2]);
+        quad->setMaterial(material);
+        quad->isInMesh = true;
+        quad->cullBackFaces = closed;
+        quad->n1 = vertex_normals[q[0]];
+        quad->n2 = vertex_normals[q[1]];
+        quad->n3 = vertex_normals[q[2]];
+        quad->n4 = vertex_normals[q[3]];
+
+        surfaces.push_back(quad);
+    }
+
+    for (unsigned int i = 0; i < tris.size() / 3; i++) {
+        if (merged[i]) {
+            delete triangles[i]->bbox;
+            delete triangles[i];
+            continue;
+        }
+
+        triangles[i]->isInMesh = true;
+        triangles[i]->cullBackFaces = closed;
+        triangles[i]->n1 = vertex_normals[tris[3 * i]];
+        triangles[i]->n2 = vertex_normals[tris[3 * i + 1]];
+        triangles[i]->n3 = vertex_normals[tris[3 * i + 2]];
+
+        surfaces.push_back(triangles[i]);
+    }
+}
+
 //
 // read the scene file.
 //
@@ -161,11 +375,12 @@ void read_wavefront_file(
 //
 void parseSceneFile(char *filename,
                     vector<Surface *> &surfaces,
-                    vector<Material *> &materials,
+                    vector<Material> &materials,
                     vector<PointLight *> &plights,
                     vector<SquareLight *> &slights,
                     AmbientLight &ambient,
-                    Camera *cam) {
+                    Camera *cam,
+                    const RenderOptions &options) {
     int Cams = 0;
 
     ifstream inFile(filename);    // open the file
@@ -176,9 +391,12 @@ void parseSceneFile(char *filename,
         exit(-1);
     }
 
-    /* Most recently added material and a default in the beginning */
-    Material *lastMaterial = new Material();
-    materials.push_back(lastMaterial);
+    /*
+     * Index of the most recently added material in the material table, and
+     * a default in the beginning
+     */
+    materials.push_back(Material());
+    uint32_t lastMaterial = 0;
 
     while (!inFile.eof()) {   // go through every line in the file until finished
 
@@ -338,69 +556,99 @@ void parseSceneFile(char *filename,
                 ig = getTokenAsFloat(line, 9);
                 ib = getTokenAsFloat(line, 10);
 
-                lastMaterial = new Material(dr, dg, db, sr, sg, sb, r, ir, ig,
-                                            ib);
-                materials.push_back(lastMaterial);
+                materials.push_back(Material(dr, dg, db, sr, sg, sb, r, ir, ig,
+                                             ib));
+                lastMaterial = (uint32_t) (materials.size() - 1);
 
                 break;
             }
 
             case 'w': { // read .obj file
-                string filename;
-                vector<Triangle *> triangles;
                 vector<int> tris;
                 vector<float> verts;
 
-                filename = line.substr(2);
-                read_wavefront_file(filename.c_str(), tris, verts);
+                /*
+                 * w <filename> [closed]
+                 * The filename runs to the end of the line, spaces and all,
+                 * unless the line ends in the word closed: a closed mesh
+                 * has its back faces culled.
+                 */
+                string filename = line.substr(2);
+                filename.erase(filename.find_last_not_of(" \t\r") + 1);
+
+                bool closed = false;
+                size_t last = filename.find_last_of(" \t");
+
+                if (last != string::npos &&
+                    filename.substr(last + 1) == "closed") {
+                    closed = true;
+                    filename.erase(filename.find_last_not_of(" \t", last) + 1);
+                }
 
-                Vector vertex_normals[verts.size() / 3];
-                for (unsigned int i = 0; i < verts.size() / 3; i++)
-                    vertex_normals[i] = Vector();
+                if (!ifstream(filename).good()) {
+                    last = filename.find_last_of(" \t");
 
-                for (unsigned int i = 0; i < tris.size() / 3; i++) {
-                    Triangle *triangle;
-                    int v1, v2, v3;
-                    float x1, y1, z1, x2, y2, z2, x3, y3, z3;
+                    /* A file followed by a word other than closed */
+                    if (last != string::npos &&
+                        ifstream(filename.substr(0, last)).good()) {
+                        cerr << "error: unknown mesh flag "
+                             << filename.substr(last + 1) << " (expected "
+                                "closed)" << endl;
+                        exit(-1);
+                    }
 
-                    v1 = tris[3 * i];
-                    v2 = tris[3 * i + 1];
-                    v3 = tris[3 * i + 2];
+                    cerr << "error: can't open mesh file " << filename
+                         << endl;
+                    exit(-1);
+                }
 
-                    x1 = verts[3 * v1];
-                    y1 = verts[3 * v1 + 1];
-                    z1 = verts[3 * v1 + 2];
+                read_wavefront_file(filename.c_str(), tris, verts);
 
-                    x2 = verts[3 * v2];
-                    y2 = verts[3 * v2 + 1];
-                    z2 = verts[3 * v2 + 2];
+                if (options.lod_threshold <= 0) {
+                    build_mesh(tris, verts, lastMaterial, closed, surfaces);
+                    break;
+                }
 
-                    x3 = verts[3 * v3];
-                    y3 = verts[3 * v3 + 1];
-                    z3 = verts[3 * v3 + 2];
+                /*
+                 * Build progressively coarser levels of detail, each with
+                 * roughly twice the edge length of the previous one, until
+                 * the mesh gets too small or stops simplifying.
+                 */
+                Mesh *mesh = new Mesh(options.lod_threshold);
+                float edge_length = Mesh::meanEdgeLength(tris, verts);
+
+                for (int level = 0; level < MAX_LOD_LEVELS; level++) {
+                    vector<Surface *> level_surfaces;
+                    vector<int> coarse_tris;
+                    vector<float> coarse_verts;
+
+                    build_mesh(tris, verts, lastMaterial, closed,
+                               level_surfaces);
+                    mesh->addLevel(level_surfaces,
+                                   Mesh::meanEdgeLength(tris, verts));
+
+                    if ((int) tris.size() / 3 < MIN_LOD_TRIANGLES)
+                        break;
 
-                    triangle = new Triangle(x1, y1, z1, x2, y2, z2, x3, y3, z3);
-                    triangle->setMaterial(lastMaterial);
+                    Mesh::decimate(tris, verts, edge_length * (2 << level),
+                                   coarse_tris, coarse_verts);
 
-                    vertex_normals[v1].plusEq(triangle->normal);
-                    vertex_normals[v2].plusEq(triangle->normal);
-                    vertex_normals[v3].plusEq(triangle->normal);
-                    triangles.push_back(triangle);
-                }
+                    if (coarse_tris.empty() ||
+                        coarse_tris.size() > 0.8 * tris.size())
+                        break;
 
-                for (unsigned int i = 0; i < verts.size() / 3; i++) {
-                    if (!vertex_normals[i].equals(Vector(0, 0, 0)))
-                        vertex_normals[i] = vertex_normals[i].norm();
+                    tris.swap(coarse_tris);
+                    verts.swap(coarse_verts);
                 }
 
-                for (unsigned int i = 0; i < tris.size() / 3; i++) {
-                    triangles[i]->isInMesh = true;
-                    triangles[i]->n1 = vertex_normals[tris[3 * i]];
-                    triangles[i]->n2 = vertex_normals[tris[3 * i + 1]];
-                    triangles[i]->n3 = vertex_normals[tris[3 * i + 2]];
+                mesh->setMaterial(lastMaterial);
+                mesh->build();
+                surfaces.push_back(mesh);
 
-                    surfaces.push_back(triangles[i]);
-                }
+                cout << "Mesh " << filename << ": levels of detail";
+                for (int level = 0; level < mesh->levelCount(); level++)
+                    cout << " " << mesh->levelSize(level);
+                cout << endl;
 
                 break;
             }
@@ -0,0 +1,118 @@
+/**
+ * @file    Quad.cc
+ * @author  agent
+ * @date    10/19/26
+ * @brief   Holds all constructors and members of the Quad class.
+ */
+
+#include "include/Quad.h"
+
+/**
+ * @brief   Constructs the parallelogram spanned by three of its corners.
+ *
+ * @details (x1, y1, z1) is the corner p1 while (x2, y2, z2) and (x4, y4, z4)
+ * are its neighbouring corners p1 + e1 and p1 + e2. The fourth corner is
+ * implied.
+ */
+Quad::Quad(float x1, float y1, float z1,
+           float x2, float y2, float z2,
+           float x4, float y4, float z4) {
+    this->isInMesh = false;
+    this->cullBackFaces = false;
+    this->p1 = Point(x1, y1, z1);
+    this->e1 = Point(x2, y2, z2).sub(p1);
+    this->e2 = Point(x4, y4, z4).sub(p1);
+
+    Vector N = e1.cross(e2);
+    float NN = N.dot(N);
+
+    normal = N.norm();
+
+    _a1 = e2.cross(N).times(1 / NN);
+    _a2 = N.cross(e1).times(1 / NN);
+
+    Point p3 = p1.moveAlong(e1).moveAlong(e2);
+
+    float x_min, x_max, y_min, y_max, z_min, z_max;
+
+    x_min = fminf(fminf(x1, x2), fminf(x4, p3.x));
+    x_max = fmaxf(fmaxf(x1, x2), fmaxf(x4, p3.x));
+    y_min = fminf(fminf(y1, y2), fminf(y4, p3.y));
+    y_max = fmaxf(fmaxf(y1, y2), fmaxf(y4, p3.y));
+    z_min = fminf(fminf(z1, z2), fminf(z4, p3.z));
+    z_max = fmaxf(fmaxf(z1, z2), fmaxf(z4, p3.z));
+
+    this->bbox = new BoundingBox(x_min, x_max, y_min, y_max, z_min, z_max);
+}
+
+float Quad::getIntersection(const Ray &ray) const {
+    Hit hit;
+    return this->getIntersection(ray, hit);
+}
+
+/**
+ * @name    getIntersection
+ * @brief   Intersects the ray with the plane of the quad and then checks the
+ *          co-ordinates of the intersection point along e1 and e2.
+ *
+ * @param ray - the ray with which intersection needs to be checked.
+ * @param hit - receives the co-ordinates (u, v) of the intersection point
+ *              along e1 and e2 and the face normal if the ray hits the quad.
+ * @returns   - the parameterized location of the intersection point on the
+ *              ray, -1 if the ray misses the quad.
+ */
+float Quad::getIntersection(const Ray &ray, Hit &hit) const {
+    float dn = ray.direction.dot(normal);
+
+    /* Ray is parallel to the plane of the quad or approaches its back */
+    if (dn == 0 || (cullBackFaces && dn > 0))
+        return -1;
+
+    float t = p1.sub(ray.origin).dot(normal) / dn;
+    if (t < 0)
+        return -1;
+
+    Vector q = ray.origin.moveAlong(ray.direction, t).sub(p1);
+
+    float u = q.dot(_a1);
+    if (u < 0 || u > 1)
+        return -1;
+
+    float v = q.dot(_a2);
+    if (v < 0 || v > 1)
+        return -1;
+
+    hit.u = u;
+    hit.v = v;
+    hit.geometric_normal = normal;
+    hit.smooth = isInMesh;
+
+    return t;
+}
+
+Vector Quad::getSurfaceNormal(const Point &p) const {
+    return normal;
+}
+
+/**
+ * @name    getSurfaceNormal
+ * @brief   Returns the normal at a hit on the quad. Mesh quads bilinearly
+ *          interpolate their corner normals using the (u, v) co-ordinates
+ *          recorded by getIntersection.
+ */
+Vector Quad::getSurfaceNormal(const Hit &hit) const {
+    if (!this->isInMesh)
+        return normal;
+
+    float u = hit.u, v = hit.v;
+
+    return n1.times((1 - u) * (1 - v))
+            .plusTimes(n2, u * (1 - v))
+            .plusTimes(n3, u * v)
+            .plusTimes(n4, (1 - u) * v)
+            .norm();
+}
+
+bool Quad::isFrontFacedTo(const Ray &ray) const {
+    return (normal.dot(ray.direction) <= 0);
+}
@@ -3,15 +3,41 @@
 //
 
 #include <iostream>
+#include <limits>
 #include "include/Ray.h"
 
+/*
+ * An empty ray, to be assigned to; it is left cheap to make so that arrays
+ * of rays can be kept around.
+ */
+Ray::Ray() {
+    this->sign[0] = this->sign[1] = this->sign[2] = 0;
+    this->t_min = 0;
+    this->t_max = 0;
+    this->cone_width = 0;
+    this->cone_spread = 0;
+}
+
 Ray::Ray(const Point &origin, const Vector &direction) {
     this->origin = origin;
     this->direction = direction;
+
+    /* Division by zero is intended and gives an infinite reciprocal */
+    this->inv_direction = Vector(1 / direction.i,
+                                 1 / direction.j,
+                                 1 / direction.k);
+    this->sign[0] = inv_direction.i < 0;
+    this->sign[1] = inv_direction.j < 0;
+    this->sign[2] = inv_direction.k < 0;
+
+    this->t_min = 0;
+    this->t_max = std::numeric_limits<float>::infinity();
+    this->cone_width = 0;
+    this->cone_spread = 0;
 }
 
 Point Ray::getPointOnIt(float t) const {
-    return origin.moveAlong(direction.times(t));;
+    return origin.moveAlong(direction, t);
 }
 
 /*
@@ -31,4 +57,11 @@ float Ray::getOffsetFromOrigin(const Point &p) const {
 
     std::cout << "error: Given point does not lie on this ray" << std::endl;
     return -1;
-}
\ No newline at end of file
+}
+
+/*
+ * Width of the ray cone at the given parameter along the ray.
+ */
+float Ray::getFootprint(float t) const {
+    return cone_width + t * cone_spread;
+}
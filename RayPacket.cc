@@ -0,0 +1,199 @@
+/**
+ * @file    RayPacket.cc
+ * @author  agent
+ * @date    10/19/26
+ * @brief   Holds the packets of coherent rays traced through the BVHTree
+ *          together.
+ */
+
+#include <math.h>
+#include "include/RayPacket.h"
+#include "include/Kernels.h"
+
+RayPacket::RayPacket() {
+    this->size = 0;
+    this->shared_origin = false;
+    this->coherent = false;
+
+    /* Unused lanes hold empty segments, which miss every box */
+    for (int r = 0; r < RAY_PACKET_SIZE; r++) {
+        lanes.ox[r] = lanes.oy[r] = lanes.oz[r] = 0;
+        lanes.ix[r] = lanes.iy[r] = lanes.iz[r] = 0;
+        lanes.sx[r] = lanes.sy[r] = lanes.sz[r] = 0;
+        lanes.t_min[r] = 1;
+        lanes.t_max[r] = 0;
+    }
+}
+
+/**
+ * @name add
+ * @brief appends a ray to the packet; the packet must not be full.
+ */
+void RayPacket::add(const Ray &ray) {
+    int r = size++;
+    const Vector &inv = ray.inv_direction;
+
+    if (r == 0) {
+        origin = ray.origin;
+        shared_origin = coherent = true;
+        inv_lo = inv_hi = inv;
+    } else {
+        shared_origin = shared_origin && ray.origin.x == origin.x &&
+                        ray.origin.y == origin.y && ray.origin.z == origin.z;
+        coherent = coherent && ray.sign[0] == lanes.sx[0] &&
+                   ray.sign[1] == lanes.sy[0] && ray.sign[2] == lanes.sz[0];
+        inv_lo = Vector(fminf(inv_lo.i, inv.i), fminf(inv_lo.j, inv.j),
+                        fminf(inv_lo.k, inv.k));
+        inv_hi = Vector(fmaxf(inv_hi.i, inv.i), fmaxf(inv_hi.j, inv.j),
+                        fmaxf(inv_hi.k, inv.k));
+    }
+
+    rays[r] = ray;
+    lanes.ox[r] = ray.origin.x;
+    lanes.oy[r] = ray.origin.y;
+    lanes.oz[r] = ray.origin.z;
+    lanes.ix[r] = ray.inv_direction.i;
+    lanes.iy[r] = ray.inv_direction.j;
+    lanes.iz[r] = ray.inv_direction.k;
+    lanes.sx[r] = ray.sign[0];
+    lanes.sy[r] = ray.sign[1];
+    lanes.sz[r] = ray.sign[2];
+    lanes.t_min[r] = ray.t_min;
+    lanes.t_max[r] = ray.t_max;
+}
+
+/**
+ * @name setFrustum
+ * @brief encloses the packet in the pyramid with the given apex and base.
+ *
+ * @param apex    - the point at which all rays of the packet end (or start).
+ * @param corners - the corners of the base of the pyramid, in order around
+ *                  it, such as the corners of an area light.
+ *
+ * @details Every ray of the packet must lie within the pyramid.
+ */
+void RayPacket::setFrustum(const Point &apex, const Point corners[4]) {
+    this->frustum = Frustum(apex, corners, true);
+}
+
+/**
+ * @name activeMask
+ * @returns a mask with one bit set for each ray in the packet.
+ */
+unsigned int RayPacket::activeMask() const {
+    return (1u << size) - 1;
+}
+
+/**
+ * @name frustumMisses
+ * @brief determines if the bounding box lies entirely outside the frustum
+ * of the packet, and is thus missed by every ray of it.
+ *
+ * @see Frustum::misses
+ */
+bool RayPacket::frustumMisses(const BoundingBox &box) const {
+    return frustum.misses(box);
+}
+
+/**
+ * @name intersectBox
+ * @brief slab tests the bounding box against all active rays of the packet.
+ *
+ * @param box    - the bounding box.
+ * @param active - mask of the rays that need to be tested.
+ *
+ * @returns the mask of the active rays whose segment intersects the box.
+ *
+ * @details Does exactly the arithmetic of BoundingBox::getIntersection, so
+ * the outcome for each ray is the same as for its own test, but over the
+ * structure of arrays of the packet with no branches so that the loop runs
+ * across the rays in vector registers, as wide as the active Kernels allow.
+ */
+unsigned int RayPacket::intersectBox(const BoundingBox &box,
+                                     unsigned int active) const {
+    float t_hits[RAY_PACKET_SIZE];
+
+    return Kernels::active->intersectBox(lanes, box, t_hits) & active;
+}
+
+/**
+ * @name intervalMisses
+ * @brief determines if the bounding box is missed by every ray of a packet
+ * of rays from a shared origin with the same direction signs.
+ *
+ * @param box   - the bounding box.
+ * @param t_far - no ray needs the box beyond this parameter.
+ *
+ * @returns true only if the box can be skipped for every ray; always false
+ * for packets without a shared origin and direction signs.
+ *
+ * @details With a shared origin the distance to each slab plane is the same
+ * for all rays, and with the same signs the near and far planes are too, so
+ * the parameters at which the rays cross a plane form an interval spanned by
+ * the range of their reciprocal directions. If the latest any ray may enter
+ * the box, by the lower ends of the intervals, is after the earliest any ray
+ * may leave it, by the upper ends, no ray passes through it.
+ * As in BoundingBox::getIntersection a NaN product (a ray parallel to a
+ * slab starting on its plane) is never selected.
+ */
+bool RayPacket::intervalMisses(const BoundingBox &box, float t_far) const {
+    if (!shared_origin || !coherent)
+        return false;
+
+    const float near[3] = {(lanes.sx[0] ? box.x_max : box.x_min) - origin.x,
+                           (lanes.sy[0] ? box.y_max : box.y_min) - origin.y,
+                           (lanes.sz[0] ? box.z_max : box.z_min) - origin.z};
+    const float far[3] = {(lanes.sx[0] ? box.x_min : box.x_max) - origin.x,
+                          (lanes.sy[0] ? box.y_min : box.y_max) - origin.y,
+                          (lanes.sz[0] ? box.z_min : box.z_max) - origin.z};
+    const float lo[3] = {inv_lo.i, inv_lo.j, inv_lo.k};
+    const float hi[3] = {inv_hi.i, inv_hi.j, inv_hi.k};
+
+    float t_enter = 0;
+    float t_exit = t_far;
+
+    for (int a = 0; a < 3; a++) {
+        float n_lo = near[a] * lo[a], n_hi = near[a] * hi[a];
+        float f_lo = far[a] * lo[a], f_hi = far[a] * hi[a];
+
+        float earliest_near = (n_hi < n_lo) ? n_hi : n_lo;
+        float latest_far = (f_hi > f_lo) ? f_hi : f_lo;
+
+        t_enter = (earliest_near > t_enter) ? earliest_near : t_enter;
+        t_exit = (latest_far < t_exit) ? latest_far : t_exit;
+    }
+
+    return t_enter > t_exit;
+}
+
+/**
+ * @name intersectBox
+ * @brief slab tests the bounding box against all active rays of the packet,
+ * also giving where each ray enters it.
+ *
+ * @param t_hits - receives, for each ray that intersects the box, the
+ *                 parameter at which it enters the box, exactly as given by
+ *                 BoundingBox::getIntersection.
+ *
+ * @details For a packet with a shared origin and direction signs the
+ * distances from the origin to the slab planes are computed once for all
+ * rays; each ray then only scales them by its reciprocal direction.
+ *
+ * @see intersectBox for the rest of the parameters.
+ */
+unsigned int RayPacket::intersectBox(const BoundingBox &box,
+                                     unsigned int active,
+                                     float *t_hits) const {
+    if (!shared_origin || !coherent)
+        return Kernels::active->intersectBox(lanes, box, t_hits) & active;
+
+    const float near[3] = {(lanes.sx[0] ? box.x_max : box.x_min) - origin.x,
+                           (lanes.sy[0] ? box.y_max : box.y_min) - origin.y,
+                           (lanes.sz[0] ? box.z_max : box.z_min) - origin.z};
+    const float far[3] = {(lanes.sx[0] ? box.x_min : box.x_max) - origin.x,
+                          (lanes.sy[0] ? box.y_min : box.y_max) - origin.y,
+                          (lanes.sz[0] ? box.z_min : box.z_max) - origin.z};
+
+    return Kernels::active->intersectBoxFrom(lanes, near, far, t_hits) &
+           active;
+}
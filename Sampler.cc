@@ -0,0 +1,195 @@
+/**
+ * @file    Sampler.cc
+ * @author  agent
+ * @date    10/19/26
+ * @brief   Holds the sample generators used for pixel and area light
+ *          sampling.
+ */
+
+#include <cstdlib>
+#include <math.h>
+#include "include/Sampler.h"
+
+using namespace std;
+
+/**
+ * @name    get
+ * @brief   Looks up a sampler by name.
+ *
+ * @param name - one of jittered, halton, sobol or cmj.
+ * @returns    - the shared instance of the sampler, nullptr for an unknown
+ *               name.
+ */
+const Sampler *Sampler::get(const string &name) {
+    static const JitteredSampler jittered;
+    static const HaltonSampler halton;
+    static const SobolSampler sobol;
+    static const CMJSampler cmj;
+
+    if (name == "jittered") return &jittered;
+    if (name == "halton") return &halton;
+    if (name == "sobol") return &sobol;
+    if (name == "cmj") return &cmj;
+    return nullptr;
+}
+
+/**
+ * @name    hashSeed
+ * @brief   Mixes the given integers into a well distributed 32 bit value.
+ */
+unsigned int hashSeed(unsigned int a, unsigned int b) {
+    unsigned int h = a * 0x9e3779b9u ^ (b + 0x7f4a7c15u);
+
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+/**
+ * @brief   Maps a 32 bit integer to a float in [0, 1).
+ */
+static inline float toUnitFloat(unsigned int bits) {
+    return (bits >> 8) * (1.0f / 16777216.0f);
+}
+
+/**
+ * @details Point k lies in block (k / cols, k % cols), which for a perfect
+ * square count matches the order of the nested p, q strata loops it
+ * replaces, so that renders stay the same.
+ */
+void JitteredSampler::get2D(int k, int count, unsigned int seed,
+                            float &u, float &v) const {
+    /* Largest factor of count not above its square root */
+    int rows = (int) sqrtf((float) count);
+    while (count % rows != 0)
+        rows--;
+
+    int cols = count / rows;
+
+    u = (k / cols + ((float) rand() / RAND_MAX)) / rows;
+    v = (k % cols + ((float) rand() / RAND_MAX)) / cols;
+}
+
+/**
+ * @brief   Radical inverse of k in the given base.
+ */
+static inline float radicalInverse(unsigned int k, unsigned int base) {
+    float inv_base = 1.0f / base, f = inv_base, r = 0;
+
+    for (; k > 0; k /= base, f *= inv_base)
+        r += (k % base) * f;
+    return r;
+}
+
+void HaltonSampler::get2D(int k, int count, unsigned int seed,
+                          float &u, float &v) const {
+    u = radicalInverse((unsigned int) k, 2) + toUnitFloat(hashSeed(seed, 1));
+    v = radicalInverse((unsigned int) k, 3) + toUnitFloat(hashSeed(seed, 2));
+
+    u -= floorf(u);
+    v -= floorf(v);
+}
+
+/**
+ * @details The first dimension is the van der Corput sequence (bit reversal
+ * of k), the second uses the generator matrix of the second Sobol dimension.
+ * XOR-ing with a random scramble permutes the digits of every point alike,
+ * which keeps the sequence stratified (Kollig and Keller).
+ */
+void SobolSampler::get2D(int k, int count, unsigned int seed,
+                         float &u, float &v) const {
+    unsigned int i = (unsigned int) k;
+
+    unsigned int r = i;
+    r = (r << 16) | (r >> 16);
+    r = ((r & 0x00ff00ffu) << 8) | ((r & 0xff00ff00u) >> 8);
+    r = ((r & 0x0f0f0f0fu) << 4) | ((r & 0xf0f0f0f0u) >> 4);
+    r = ((r & 0x33333333u) << 2) | ((r & 0xccccccccu) >> 2);
+    r = ((r & 0x55555555u) << 1) | ((r & 0xaaaaaaaau) >> 1);
+
+    unsigned int s = 0;
+    for (unsigned int bit = 1u << 31; i; i >>= 1, bit ^= bit >> 1)
+        if (i & 1)
+            s ^= bit;
+
+    u = toUnitFloat(r ^ hashSeed(seed, 3));
+    v = toUnitFloat(s ^ hashSeed(seed, 4));
+}
+
+/**
+ * @brief   A pseudo-random permutation of [0, l) indexed by i and selected
+ *          by p (Kensler, Correlated Multi-Jittered Sampling, 2013).
+ */
+static unsigned int permute(unsigned int i, unsigned int l, unsigned int p) {
+    unsigned int w = l - 1;
+    w |= w >> 1;
+    w |= w >> 2;
+    w |= w >> 4;
+    w |= w >> 8;
+    w |= w >> 16;
+
+    do {
+        i ^= p;
+        i *= 0xe170893d;
+        i ^= p >> 16;
+        i ^= (i & w) >> 4;
+        i ^= p >> 8;
+        i *= 0x0929eb3f;
+        i ^= p >> 23;
+        i ^= (i & w) >> 1;
+        i *= 1 | p >> 27;
+        i *= 0x6935fa69;
+        i ^= (i & w) >> 11;
+        i *= 0x74dcb303;
+        i ^= (i & w) >> 2;
+        i *= 0x9e501cc3;
+        i ^= (i & w) >> 2;
+        i *= 0xc860a3df;
+        i &= w;
+        i ^= i >> 5;
+    } while (i >= l);
+
+    return (i + p) % l;
+}
+
+/**
+ * @brief   A pseudo-random float in [0, 1) indexed by i and selected by p.
+ */
+static float randFloat(unsigned int i, unsigned int p) {
+    i ^= p;
+    i ^= i >> 17;
+    i ^= i >> 10;
+    i *= 0xb36534e5;
+    i ^= i >> 12;
+    i ^= i >> 21;
+    i *= 0x93fc4795;
+    i ^= 0xdf6e307f;
+    i ^= i >> 17;
+    i *= 1 | p >> 18;
+    return toUnitFloat(i);
+}
+
+/**
+ * @details The count points occupy the first cells of an m x n grid in
+ * shuffled order. Each point is jittered within its cell and, as in
+ * multi-jittered sampling, also falls into its own one of count strips
+ * along each axis.
+ */
+void CMJSampler::get2D(int k, int count, unsigned int seed,
+                       float &u, float &v) const {
+    unsigned int p = seed;
+    unsigned int m = (unsigned int) sqrtf((float) count);
+    unsigned int n = (count + m - 1) / m;
+
+    unsigned int s = permute((unsigned int) k, count, p * 0x51633e2d);
+    unsigned int sx = permute(s % m, m, p * 0x68bc21eb);
+    unsigned int sy = permute(s / m, n, p * 0x02e5be93);
+    float jx = randFloat(s, p * 0x967a889b);
+    float jy = randFloat(s, p * 0x368cc8b7);
+
+    u = (sx + (sy + jx) / n) / m;
+    v = (s + jy) / count;
+}
@@ -30,10 +30,18 @@ float Sphere::getIntersection(const Ray &ray) const {
     return fminf(t1, t2);
 }
 
+float Sphere::getIntersection(const Ray &ray, Hit &hit) const {
+    return this->getIntersection(ray);
+}
+
 Vector Sphere::getSurfaceNormal(const Point &p) const {
     return Vector(p.x - center.x, p.y - center.y, p.z - center.z).norm();
 }
 
+Vector Sphere::getSurfaceNormal(const Hit &hit) const {
+    return this->getSurfaceNormal(hit.point);
+}
+
 /*
  * Will always be front faced to any ray since its an enclosed object.
  */
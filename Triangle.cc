@@ -8,6 +8,7 @@ Triangle::Triangle(float x1, float y1, float z1,
                    float x2, float y2, float z2,
                    float x3, float y3, float z3) {
     this->isInMesh = false;
+    this->cullBackFaces = false;
     this->p1 = Point(x1, y1, z1);
     this->p2 = Point(x2, y2, z2);
     this->p3 = Point(x3, y3, z3);
@@ -36,6 +37,26 @@ Triangle::Triangle(float x1, float y1, float z1,
 }
 
 float Triangle::getIntersection(const Ray &ray) const {
+    Hit hit;
+    return this->getIntersection(ray, hit);
+}
+
+/**
+ * @name    getIntersection
+ * @brief   Intersects the ray with the triangle using Cramer's rule and
+ *          records the barycentric co-ordinates of the intersection point.
+ *
+ * @param ray - the ray with which intersection needs to be checked.
+ * @param hit - receives the barycentric weights of p2 (u) and p3 (v) and
+ *              the face normal if the ray intersects the triangle; left
+ *              untouched otherwise.
+ *
+ * @note if back faces are culled rays hitting the triangle from behind miss
+ *       it, which is decided before any work depending on the ray origin.
+ * @returns   - the parameterized location of the intersection point on the
+ *              ray, -1 if the ray misses the triangle.
+ */
+float Triangle::getIntersection(const Ray &ray, Hit &hit) const {
     float g, h, i, j, k, l;
     float eihf, gfdi, dheg, akjb, jcal, blkc;
     float M, t, beta, gamma;
@@ -43,19 +64,26 @@ float Triangle::getIntersection(const Ray &ray) const {
     g = ray.direction.i;
     h = ray.direction.j;
     i = ray.direction.k;
-    j = this->p1.x - ray.origin.x;
-    k = this->p1.y - ray.origin.y;
-    l = this->p1.z - ray.origin.z;
 
     eihf = _e * i - h * _f;
     gfdi = g * _f - _d * i;
     dheg = _d * h - _e * g;
+
+    /* M is the dot product of the ray direction and the (scaled) normal */
+    M = _a * eihf + _b * gfdi + _c * dheg;
+
+    /* Ray approaches the back side of the triangle */
+    if (cullBackFaces && M >= 0)
+        return -1;
+
+    j = this->p1.x - ray.origin.x;
+    k = this->p1.y - ray.origin.y;
+    l = this->p1.z - ray.origin.z;
+
     akjb = _a * k - j * _b;
     jcal = j * _c - _a * l;
     blkc = _b * l - k * _c;
 
-    M = _a * eihf + _b * gfdi + _c * dheg;
-
     t = (-_f * akjb - _e * jcal - _d * blkc) / M;
     if (t < 0)
         return -1;
@@ -68,6 +96,11 @@ float Triangle::getIntersection(const Ray &ray) const {
     if (beta < 0 || beta > 1 - gamma)
         return -1;
 
+    hit.u = beta;
+    hit.v = gamma;
+    hit.geometric_normal = normal;
+    hit.smooth = isInMesh;
+
     return t;
 }
 
@@ -109,8 +142,24 @@ Vector Triangle::getSurfaceNormal(const Point &p) const {
     gamma = (-f * akjb - e * jcal - d * blkc) / M;
 
     return n1.times(alpha)
-            .plus(n2.times(beta))
-            .plus(n3.times(gamma))
+            .plusTimes(n2, beta)
+            .plusTimes(n3, gamma)
+            .norm();
+}
+
+/**
+ * @name    getSurfaceNormal
+ * @brief   Returns the normal at a hit on the triangle. Mesh triangles
+ *          interpolate their vertex normals with the barycentric weights
+ *          already recorded by getIntersection.
+ */
+Vector Triangle::getSurfaceNormal(const Hit &hit) const {
+    if (!this->isInMesh)
+        return normal;
+
+    return n1.times(1 - hit.u - hit.v)
+            .plusTimes(n2, hit.u)
+            .plusTimes(n3, hit.v)
             .norm();
 }
 
@@ -0,0 +1,430 @@
+/**
+ * @file    VisibilityBuffer.cc
+ * @author  agent
+ * @date    10/19/26
+ * @brief   Holds the rasterizer finding the surfaces seen through every
+ *          primary sample.
+ */
+
+#include <math.h>
+#include <atomic>
+#include <thread>
+#include <algorithm>
+#include "include/VisibilityBuffer.h"
+#include "include/Camera.h"
+#include "include/Triangle.h"
+#include "include/Quad.h"
+#include "include/Sphere.h"
+
+using namespace std;
+
+/*
+ * Slack given to the edges of primitives, as the sine of an angle at the
+ * eye (a small fraction of a pixel), so that rounding never leaves out a
+ * sample whose ray hits the primitive right at its edge.
+ */
+static const float RASTER_EPSILON = 1e-4f;
+
+/*
+ * Closest a primitive may be to the eye along a primary ray, as in the
+ * closest hit searches of BVHTree.
+ */
+static const float RASTER_T_MIN = 0.05f;
+
+/* Primitives closer than this to the plane of the eye cover every pixel */
+static const float RASTER_NEAR = 1e-3f;
+
+VisibilityBuffer::VisibilityBuffer() {
+    this->pw = 0;
+    this->ph = 0;
+    this->p_samples = 0;
+    this->threads = 0;
+}
+
+/**
+ * @brief   The co-ordinates of a point in the frame of the camera.
+ */
+static Point toCamera(const Camera &camera, const Point &p) {
+    Vector rel = p.sub(camera.eye);
+
+    return Point(rel.dot(camera.u), rel.dot(camera.v), rel.dot(camera.w));
+}
+
+/**
+ * @name    setBounds
+ * @brief   Bounds the pixels a primitive may cover by projecting the corners
+ *          of a convex shape around it onto the image plane.
+ *
+ * @param camera  - the camera.
+ * @param raster  - the primitive, whose pixel bounds are set.
+ * @param corners - the corners of the shape, in the frame of the camera.
+ * @param count   - the number of corners.
+ *
+ * @details A shape reaching behind (or too close to) the plane of the eye
+ * has no bounded projection, so it is taken to cover the whole image.
+ */
+void VisibilityBuffer::setBounds(const Camera &camera, RasterPrimitive &raster,
+                                 const Point *corners, int count) {
+    float width = camera.right - camera.left;
+    float height = camera.top - camera.bottom;
+    float x_min = INFINITY, x_max = -INFINITY;
+    float y_min = INFINITY, y_max = -INFINITY;
+
+    raster.x0 = 0;
+    raster.y0 = 0;
+    raster.x1 = pw;
+    raster.y1 = ph;
+
+    for (int c = 0; c < count; c++) {
+        if (corners[c].z > -RASTER_NEAR)
+            return;
+
+        float x = corners[c].x * camera.d / -corners[c].z;
+        float y = corners[c].y * camera.d / -corners[c].z;
+
+        x_min = fminf(x_min, x);
+        x_max = fmaxf(x_max, x);
+        y_min = fminf(y_min, y);
+        y_max = fmaxf(y_max, y);
+    }
+
+    /* Pixels holding the bounds, and one more around them for the slack */
+    float col_min = (x_min - camera.left) * pw / width - 1;
+    float col_max = (x_max - camera.left) * pw / width + 2;
+    float row_min = (y_min - camera.bottom) * ph / height - 1;
+    float row_max = (y_max - camera.bottom) * ph / height + 2;
+
+    raster.x0 = (int) fmaxf(0, floorf(col_min));
+    raster.x1 = (int) fminf(pw, floorf(col_max));
+    raster.y0 = (int) fmaxf(0, floorf(row_min));
+    raster.y1 = (int) fminf(ph, floorf(row_max));
+}
+
+/**
+ * @name    addTriangle
+ * @brief   Sets up a triangle for rasterization.
+ *
+ * @param surface_idx - index of the surface the triangle belongs to.
+ * @param primitive   - the triangle, or the quad it is half of.
+ * @param p1 | @param p2 | @param p3 - the corners of the triangle.
+ *
+ * @details A sample lies within the triangle if its ray is on the inner side
+ * of the three planes through the eye and each edge, which unlike edges on
+ * the image plane needs no clipping for triangles reaching behind the eye.
+ * A triangle in a plane through the eye is seen edge on and is left out.
+ */
+void VisibilityBuffer::addTriangle(const Camera &camera, int surface_idx,
+                                   const Surface *primitive, const Point &p1,
+                                   const Point &p2, const Point &p3) {
+    Point corners[3] = {toCamera(camera, p1), toCamera(camera, p2),
+                        toCamera(camera, p3)};
+    Vector a(corners[0].x, corners[0].y, corners[0].z);
+    Vector b(corners[1].x, corners[1].y, corners[1].z);
+    Vector c(corners[2].x, corners[2].y, corners[2].z);
+
+    RasterPrimitive raster;
+    raster.surface_idx = surface_idx;
+    raster.primitive = primitive;
+    raster.sphere = false;
+    raster.edges[0] = b.cross(c);
+    raster.edges[1] = c.cross(a);
+    raster.edges[2] = a.cross(b);
+    raster.normal = b.plus(-a).cross(c.plus(-a));
+    raster.offset = raster.normal.dot(a);
+    raster.radius2 = 0;
+
+    float det = a.dot(raster.edges[0]);
+    if (det == 0 || raster.offset == 0)
+        return;
+
+    for (int e = 0; e < 3; e++) {
+        float length = sqrtf(raster.edges[e].dot(raster.edges[e]));
+
+        if (length == 0)
+            return;
+
+        raster.edges[e] = raster.edges[e].times((det > 0 ? 1 : -1) / length);
+    }
+
+    setBounds(camera, raster, corners, 3);
+
+    if (raster.x0 < raster.x1 && raster.y0 < raster.y1)
+        primitives.push_back(raster);
+}
+
+/**
+ * @name    addSphere
+ * @brief   Sets up a sphere for rasterization; its pixels are bounded by its
+ *          bounding box.
+ */
+void VisibilityBuffer::addSphere(const Camera &camera, int surface_idx,
+                                 const Surface *primitive,
+                                 const Point &center, float radius) {
+    RasterPrimitive raster;
+    raster.surface_idx = surface_idx;
+    raster.primitive = primitive;
+    raster.sphere = true;
+    raster.center = toCamera(camera, center);
+    raster.radius2 = radius * radius;
+    raster.offset = 0;
+
+    Point corners[8];
+    for (int c = 0; c < 8; c++)
+        corners[c] = Point(raster.center.x + ((c & 1) ? radius : -radius),
+                           raster.center.y + ((c & 2) ? radius : -radius),
+                           raster.center.z + ((c & 4) ? radius : -radius));
+
+    setBounds(camera, raster, corners, 8);
+
+    if (raster.x0 < raster.x1 && raster.y0 < raster.y1)
+        primitives.push_back(raster);
+}
+
+/**
+ * @name    setUp
+ * @brief   Sets up every triangle, quad and sphere of the scene for
+ *          rasterization; other surfaces are listed as unrasterized.
+ *
+ * @details Primitives only ever hit from the front (those of closed meshes)
+ * are left out when the eye is behind them.
+ */
+void VisibilityBuffer::setUp(const Camera &camera, const BVHTree &surfaces) {
+    primitives.clear();
+    unrasterized.clear();
+
+    for (int s = 0; s < surfaces.size(); s++) {
+        const Surface *surface = surfaces.at(s);
+        const Triangle *triangle = dynamic_cast<const Triangle *>(surface);
+        const Quad *quad = dynamic_cast<const Quad *>(surface);
+        const Sphere *sphere = dynamic_cast<const Sphere *>(surface);
+
+        if (triangle != nullptr) {
+            if (triangle->cullBackFaces &&
+                triangle->p1.sub(camera.eye).dot(triangle->normal) >= 0)
+                continue;
+
+            addTriangle(camera, s, triangle, triangle->p1, triangle->p2,
+                        triangle->p3);
+        } else if (quad != nullptr) {
+            if (quad->cullBackFaces &&
+                quad->p1.sub(camera.eye).dot(quad->normal) > 0)
+                continue;
+
+            Point p2 = quad->p1.moveAlong(quad->e1);
+            Point p3 = p2.moveAlong(quad->e2);
+            Point p4 = quad->p1.moveAlong(quad->e2);
+
+            addTriangle(camera, s, quad, quad->p1, p2, p3);
+            addTriangle(camera, s, quad, quad->p1, p3, p4);
+        } else if (sphere != nullptr) {
+            addSphere(camera, s, sphere, sphere->center, sphere->radius);
+        } else {
+            unrasterized.push_back(s);
+        }
+    }
+}
+
+/**
+ * @name    rasterizeTile
+ * @brief   Tests the samples of a tile of pixels against the primitives
+ *          binned to it, keeping the nearest primitive of each sample.
+ *
+ * @param tile_x | @param tile_y - the tile, in units of RASTER_TILE_SIZE.
+ * @param bin    - the primitives whose bounds overlap the tile.
+ *
+ * @details The ray of a sample passes through the point (x, y, -d) of the
+ * image plane, so the depth of a primitive along it is found where that
+ * direction meets the plane of a triangle, or by solving for the nearer
+ * intersection with a sphere.
+ */
+void VisibilityBuffer::rasterizeTile(const Camera &camera, int tile_x,
+                                     int tile_y, const vector<int> &bin) {
+    float width = camera.right - camera.left;
+    float height = camera.top - camera.bottom;
+    float d = camera.d;
+
+    int tx0 = tile_x * RASTER_TILE_SIZE, tx1 = min(tx0 + RASTER_TILE_SIZE, pw);
+    int ty0 = tile_y * RASTER_TILE_SIZE, ty1 = min(ty0 + RASTER_TILE_SIZE, ph);
+
+    for (int id : bin) {
+        const RasterPrimitive &raster = primitives[id];
+        const Vector *edges = raster.edges;
+        const Point &c = raster.center;
+
+        /* Spheres cover samples within a slightly larger radius */
+        float slack_radius2 = raster.radius2 * (1 + RASTER_EPSILON) *
+                              (1 + RASTER_EPSILON);
+        float cc = c.x * c.x + c.y * c.y + c.z * c.z;
+
+        for (int i = max(ty0, raster.y0); i < min(ty1, raster.y1); i++) {
+            for (int j = max(tx0, raster.x0); j < min(tx1, raster.x1); j++) {
+                for (int k = 0; k < p_samples; k++) {
+                    size_t idx = sampleIndex(i, j, k);
+                    float x = camera.left + width * (j + x_offsets[idx]) / pw;
+                    float y = camera.bottom + height * (i + y_offsets[idx]) /
+                                              ph;
+                    float length2 = x * x + y * y + d * d;
+                    float length = sqrtf(length2);
+                    float t;
+
+                    if (raster.sphere) {
+                        float b = c.x * x + c.y * y - c.z * d;
+                        float disc = b * b - length2 * (cc - slack_radius2);
+
+                        if (disc < 0)
+                            continue;
+
+                        float root = sqrtf(fmaxf(0, b * b - length2 *
+                                                        (cc - raster.radius2)));
+
+                        t = (b - root) / length2 * length;
+                        if (t < RASTER_T_MIN)
+                            t = (b + root) / length2 * length;
+                    } else {
+                        float slack = -RASTER_EPSILON * length;
+
+                        if (edges[0].i * x + edges[0].j * y -
+                            edges[0].k * d < slack ||
+                            edges[1].i * x + edges[1].j * y -
+                            edges[1].k * d < slack ||
+                            edges[2].i * x + edges[2].j * y -
+                            edges[2].k * d < slack)
+                            continue;
+
+                        const Vector &n = raster.normal;
+                        t = raster.offset / (n.i * x + n.j * y - n.k * d) *
+                            length;
+                    }
+
+                    /* Also drops the NaN of a ray parallel to a triangle */
+                    if (t >= RASTER_T_MIN && t < depths[idx]) {
+                        depths[idx] = t;
+                        ids[idx] = id;
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @name    build
+ * @brief   Rasterizes the scene into the buffer.
+ *
+ * @param camera   - the camera the image is taken by.
+ * @param surfaces - contains all surfaces in two forms: BVHTree & array.
+ * @param options  - options.p_samples samples are taken per pixel, placed on
+ *                   it by options.sampler.
+ *
+ * @details The samples are placed first, pixel by pixel, so that primary
+ * rays can later be sent through exactly the same points. The primitives are
+ * then binned to the tiles their bounds overlap, and the tiles are handed
+ * out to as many threads as the machine runs at once.
+ */
+void VisibilityBuffer::build(const Camera &camera, const BVHTree &surfaces,
+                             const RenderOptions &options) {
+    this->pw = camera.pw;
+    this->ph = camera.ph;
+    this->p_samples = options.p_samples;
+
+    size_t samples = (size_t) pw * ph * p_samples;
+
+    x_offsets.resize(samples);
+    y_offsets.resize(samples);
+    ids.assign(samples, -1);
+    depths.assign(samples, INFINITY);
+
+    for (int i = 0; i < ph; i++) {
+        for (int j = 0; j < pw; j++) {
+            unsigned int seed = hashSeed((unsigned int) i, (unsigned int) j);
+
+            for (int k = 0; k < p_samples; k++) {
+                size_t idx = sampleIndex(i, j, k);
+                options.sampler->get2D(k, p_samples, seed, x_offsets[idx],
+                                       y_offsets[idx]);
+            }
+        }
+    }
+
+    setUp(camera, surfaces);
+
+    int tiles_x = (pw + RASTER_TILE_SIZE - 1) / RASTER_TILE_SIZE;
+    int tiles_y = (ph + RASTER_TILE_SIZE - 1) / RASTER_TILE_SIZE;
+    vector<vector<int> > bins((size_t) tiles_x * tiles_y);
+
+    for (int id = 0; id < (int) primitives.size(); id++) {
+        const RasterPrimitive &raster = primitives[id];
+
+        for (int ty = raster.y0 / RASTER_TILE_SIZE;
+             ty <= (raster.y1 - 1) / RASTER_TILE_SIZE; ty++)
+            for (int tx = raster.x0 / RASTER_TILE_SIZE;
+                 tx <= (raster.x1 - 1) / RASTER_TILE_SIZE; tx++)
+                bins[ty * tiles_x + tx].push_back(id);
+    }
+
+    this->threads = max(1, min((int) thread::hardware_concurrency(),
+                               tiles_x * tiles_y));
+
+    atomic<int> next_tile(0);
+    vector<thread> workers;
+
+    for (int n = 0; n < threads; n++) {
+        workers.push_back(thread([&]() {
+            int tile;
+
+            while ((tile = next_tile++) < tiles_x * tiles_y)
+                rasterizeTile(camera, tile % tiles_x, tile / tiles_x,
+                              bins[tile]);
+        }));
+    }
+
+    for (thread &worker : workers)
+        worker.join();
+}
+
+/**
+ * @brief   Index of the k-th sample of pixel (i, j) in the buffer.
+ */
+size_t VisibilityBuffer::sampleIndex(int i, int j, int k) const {
+    return ((size_t) i * pw + j) * p_samples + k;
+}
+
+/**
+ * @name    getOffsets
+ * @brief   Gives the position of the k-th sample within pixel (i, j), in
+ *          row i and column j.
+ */
+void VisibilityBuffer::getOffsets(int i, int j, int k,
+                                  float &x_d, float &y_d) const {
+    size_t idx = sampleIndex(i, j, k);
+
+    x_d = x_offsets[idx];
+    y_d = y_offsets[idx];
+}
+
+/**
+ * @name    lookup
+ * @returns the nearest primitive rasterized at the k-th sample of pixel
+ *          (i, j), nullptr if no rasterized surface covers it.
+ */
+const RasterPrimitive *VisibilityBuffer::lookup(int i, int j, int k) const {
+    int id = ids[sampleIndex(i, j, k)];
+
+    return (id == -1) ? nullptr : &primitives[id];
+}
+
+const vector<int> &VisibilityBuffer::unrasterizedSurfaces() const {
+    return unrasterized;
+}
+
+size_t VisibilityBuffer::primitiveCount() const {
+    return primitives.size();
+}
+
+size_t VisibilityBuffer::sampleCount() const {
+    return ids.size();
+}
+
+int VisibilityBuffer::threadCount() const {
+    return threads;
+}
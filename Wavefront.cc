@@ -0,0 +1,932 @@
+/**
+ * @file    Wavefront.cc
+ * @author  agent
+ * @date    10/19/26
+ * @brief   Holds the stages of the wavefront renderer of the Camera class.
+ *
+ * The wavefront renderer computes the same image as the depth first one
+ * (Camera::getShadeAlongRay) but breaks it up into stages, each of which
+ * runs over a whole batch of rays before the next one starts: generate
+ * primary rays, find their closest hits, build shadow rays, test those for
+ * occlusion, shade the hits and spawn reflected rays, which go through the
+ * stages again. Every stage thus runs a single small kernel over a queue of
+ * similar rays, and can be tuned (ordering, packets, vectors) on its own.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include "include/Camera.h"
+#include "include/Kernels.h"
+#include "include/ProgressBar.h"
+
+using namespace std;
+
+/**
+ * @name    generatePrimaryRays
+ * @brief   Fills the queue of paths with the primary rays of a tile of
+ *          pixels.
+ *
+ * @param x0 | @param y0 | @param x1 | @param y1 - the tile: the pixels in
+ *                    columns [x0, x1) of rows [y0, y1).
+ * @param width | @param height - the size of the image plane.
+ * @param sample_spread - angle subtended by a single pixel sample at the eye.
+ * @param options   - options.p_samples rays are generated per pixel, placed
+ *                    on it by options.sampler.
+ * @param buffer    - if given, places the rays on the pixels instead of the
+ *                    sampler, through the samples it was rasterized at.
+ * @param queues    - the queues of the tile; emptied first.
+ *
+ * @details The rays are queued by blocks of PACKET_BLOCK_SIZE^2 pixels,
+ * with the k-th rays of all pixels of a block one after the other, so that
+ * neighbouring rays in the queue pass through neighbouring pixels.
+ */
+void Camera::generatePrimaryRays(int x0, int y0, int x1, int y1,
+                                 float width, float height,
+                                 float sample_spread,
+                                 const RenderOptions &options,
+                                 const VisibilityBuffer *buffer,
+                                 WavefrontQueues &queues) const {
+    int p_samples = options.p_samples;
+    int tile_width = x1 - x0;
+
+    queues.paths.clear();
+    queues.shades.assign((size_t) (x1 - x0) * (y1 - y0) * p_samples,
+                         RGB(0, 0, 0));
+
+    for (int by = y0; by < y1; by += PACKET_BLOCK_SIZE) {
+        for (int bx = x0; bx < x1; bx += PACKET_BLOCK_SIZE) {
+            for (int k = 0; k < p_samples; k++) {
+                for (int i = by; i < min(by + PACKET_BLOCK_SIZE, y1); i++) {
+                    for (int j = bx; j < min(bx + PACKET_BLOCK_SIZE, x1);
+                         j++) {
+                        unsigned int seed = hashSeed((unsigned int) i,
+                                                     (unsigned int) j);
+                        int pixel = (i - y0) * tile_width + (j - x0);
+                        float x_d, y_d;
+
+                        if (buffer != nullptr)
+                            buffer->getOffsets(i, j, k, x_d, y_d);
+                        else
+                            options.sampler->get2D(k, p_samples, seed,
+                                                   x_d, y_d);
+
+                        Point px_sample = this->getPixelSample(j, i, width,
+                                                               height,
+                                                               x_d, y_d);
+
+                        Ray view_ray(this->eye,
+                                     px_sample.sub(this->eye).norm());
+                        view_ray.cone_spread = sample_spread;
+
+                        queues.paths.push_back(
+                                PathState(pixel * p_samples + k, view_ray,
+                                          RGB(1, 1, 1),
+                                          shadowWindow(seed, k, p_samples,
+                                                       options)));
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @name    findClosestHits
+ * @brief   Finds and resolves the closest hit of every path in the queue.
+ *
+ * @param surfaces  - contains all surfaces in two forms: BVHTree & array.
+ * @tparam MODE     - @see README.md - Run Modes
+ * @param paths     - the paths; a path whose ray leaves the scene is left
+ *                    with a hit without a surface.
+ * @param predictor - predicts the hits of primary rays, nullptr for none.
+ * @param entry     - for primary rays, the node of the BVHTree to start their
+ *                    searches at, nullptr for the root.
+ */
+template <int MODE>
+void Camera::findClosestHits(const BVHTree &surfaces,
+                             vector<PathState> &paths,
+                             HitPredictor *predictor,
+                             const BVHNode *entry) const {
+    for (PathState &path : paths) {
+        path.hit = getClosestSurface<MODE>(surfaces, path.ray, predictor,
+                                           entry);
+
+        if (path.hit.surface_idx != -1)
+            resolveHit<MODE>(surfaces, path.ray, path.hit);
+    }
+}
+
+/**
+ * @name    findClosestHitsInPackets
+ * @brief   Finds and resolves the closest hit of every path in the queue,
+ *          tracing the rays of consecutive paths together as packets.
+ *
+ * @details Meant for primary rays, which share the eye as their origin and,
+ * queued by blocks of pixels, have nearly the same direction.
+ *
+ * @see findClosestHits for the parameters.
+ */
+template <int MODE>
+void Camera::findClosestHitsInPackets(const BVHTree &surfaces,
+                                      vector<PathState> &paths,
+                                      const BVHNode *entry) const {
+    Hit hits[RAY_PACKET_SIZE];
+
+    for (size_t first = 0; first < paths.size(); first += RAY_PACKET_SIZE) {
+        size_t last = min(first + RAY_PACKET_SIZE, paths.size());
+        RayPacket packet;
+
+        for (size_t p = first; p < last; p++)
+            packet.add(paths[p].ray);
+
+        surfaces.getClosestSurfaces<MODE>(packet, hits, entry);
+
+        for (size_t p = first; p < last; p++) {
+            PathState &path = paths[p];
+
+            path.hit = hits[p - first];
+            if (path.hit.surface_idx != -1)
+                resolveHit<MODE>(surfaces, path.ray, path.hit);
+        }
+    }
+}
+
+/**
+ * @name    findClosestHitsInBuffer
+ * @brief   Finds and resolves the closest hit of every primary path of a
+ *          tile from the surfaces rasterized into the visibility buffer.
+ *
+ * @param surfaces - contains all surfaces in two forms: BVHTree & array.
+ * @param buffer   - the visibility buffer of the image.
+ * @param x0 | @param y0 | @param x1 - the tile: the pixels from column x0
+ *                   and row y0 on, x1 - x0 of them per row.
+ * @param p_samples - the number of primary samples per pixel.
+ * @param paths    - the primary paths of the tile.
+ * @param traced   - counts the paths which had to be traced.
+ *
+ * @details The ray of each path is only intersected with the primitive seen
+ * through its sample, and with the surfaces that are not rasterized. If the
+ * ray misses that primitive, which happens where the rasterizer covered a
+ * sample next to the edge of one, it is traced through the BVHTree instead.
+ */
+void Camera::findClosestHitsInBuffer(const BVHTree &surfaces,
+                                     const VisibilityBuffer &buffer,
+                                     int x0, int y0, int x1, int p_samples,
+                                     vector<PathState> &paths,
+                                     long &traced) const {
+    int tile_width = x1 - x0;
+
+    for (PathState &path : paths) {
+        int pixel = path.sample / p_samples;
+        const RasterPrimitive *raster =
+                buffer.lookup(y0 + pixel / tile_width,
+                              x0 + pixel % tile_width,
+                              path.sample % p_samples);
+        Hit closest;
+
+        if (raster != nullptr) {
+            Hit candidate;
+            float t = raster->primitive->getIntersection(path.ray, candidate);
+
+            if (t < 0.05) {
+                path.hit = getClosestSurface<-1>(surfaces, path.ray);
+                traced++;
+
+                if (path.hit.surface_idx != -1)
+                    resolveHit<-1>(surfaces, path.ray, path.hit);
+                continue;
+            }
+
+            closest = candidate;
+            closest.t = t;
+            closest.surface_idx = raster->surface_idx;
+            closest.primitive = raster->primitive;
+        }
+
+        for (int surface_idx : buffer.unrasterizedSurfaces()) {
+            const Surface *surface = surfaces.at(surface_idx);
+            Hit candidate;
+            candidate.t = closest.t;
+            float t = surface->getIntersection(path.ray, candidate);
+
+            if (t >= 0.05 && t < closest.t) {
+                closest = candidate;
+                closest.t = t;
+                closest.surface_idx = surface_idx;
+
+                if (closest.primitive == nullptr)
+                    closest.primitive = surface;
+            }
+        }
+
+        path.hit = closest;
+        if (path.hit.surface_idx != -1)
+            resolveHit<-1>(surfaces, path.ray, path.hit);
+    }
+}
+
+/**
+ * @brief   Queues the shadow ray from a point light to the hit of a path,
+ *          built as in Camera::shadeFromPointLight.
+ */
+static void queuePointLightRay(vector<ShadowRay> &shadow_rays, int path_idx,
+                               const PathState &path,
+                               const PointLight *light,
+                               int sum, float scale) {
+    const Hit &hit = path.hit;
+    Ray light_ray(light->position, hit.point.sub(light->position).norm());
+
+    float t_max = light_ray.getOffsetFromOrigin(hit.point);
+    light_ray.cone_spread = path.ray.getFootprint(hit.t) / t_max;
+    light_ray.t_max = t_max;
+
+    shadow_rays.push_back(ShadowRay(path_idx, light_ray, nullptr,
+                                    light->color, sum, scale, true));
+}
+
+/**
+ * @name    queueSquareLightRays
+ * @brief   Queues the shadow rays from the samples on a square light to the
+ *          hit of a path, built as in Camera::sampleSquareLight.
+ *
+ * @param sum | @param scale - where and with what weight the average shade
+ *                    of the samples is added to the path.
+ */
+void Camera::queueSquareLightRays(vector<ShadowRay> &shadow_rays,
+                                  int path_idx, const PathState &path,
+                                  const SquareLight *light,
+                                  const RenderOptions &options,
+                                  int sum, float scale) const {
+    const Hit &hit = path.hit;
+    const SampleWindow &window = path.window;
+    float footprint = path.ray.getFootprint(hit.t);
+
+    unsigned int seed;
+    int s_samples = getSquareLightSamples(light, hit, options, window, seed);
+
+    scale *= 1.0f / s_samples;
+
+    for (int k = 0; k < s_samples; k++) {
+        float u_d, v_d;
+
+        if (window.total > 0)
+            options.sampler->get2D(window.first + k, window.total, seed,
+                                   u_d, v_d);
+        else
+            options.sampler->get2D(k, s_samples, seed, u_d, v_d);
+
+        Point light_sample = light->getLightSample(u_d, v_d);
+        Ray light_ray(light_sample, hit.point.sub(light_sample).norm());
+
+        float t_max = light_ray.getOffsetFromOrigin(hit.point);
+        light_ray.cone_spread = footprint / t_max;
+        light_ray.t_max = t_max;
+
+        /* Attenuating the light by the angle it leaves the light at */
+        float cos = fmaxf(0, light_ray.direction.dot(light->w));
+
+        shadow_rays.push_back(ShadowRay(path_idx, light_ray, light,
+                                        light->color.times(cos), sum, scale,
+                                        k == s_samples - 1));
+    }
+}
+
+/**
+ * @name    castShadowRays
+ * @brief   Fills the queue of shadow rays with the rays from every light
+ *          that shades the hit of each path.
+ *
+ * @param options  - the lights are picked as by getShadeAlongRay: all of
+ *                   them, options.light_samples of them from the LightTree,
+ *                   or those reaching the hit with options.light_cutoff.
+ *
+ * @see getShadeAlongRay for the rest of the parameters.
+ */
+void Camera::castShadowRays(const vector<Material> &materials,
+                            const vector<PointLight *> &plights,
+                            const vector<SquareLight *> &slights,
+                            const LightTree &lights,
+                            const BVHTree &surfaces,
+                            const RenderOptions &options,
+                            WavefrontQueues &queues) const {
+    vector<ShadowRay> &shadow_rays = queues.shadow_rays;
+
+    shadow_rays.clear();
+
+    for (int p = 0; p < (int) queues.paths.size(); p++) {
+        const PathState &path = queues.paths[p];
+        const Hit &hit = path.hit;
+
+        if (hit.surface_idx == -1)
+            continue;
+
+        /* No light can reflect off the front face of a black material */
+        const Material &material =
+                materials[surfaces.at(hit.surface_idx)->material_idx];
+
+        if (material.black && hit.front_faced)
+            continue;
+
+        if (options.light_samples > 0) {
+            for (int n = 0; n < options.light_samples; n++) {
+                float pdf;
+                int light_idx = lights.sample(hit.point, pdf);
+
+                if (light_idx == -1 || pdf <= 0 ||
+                    !lights.influences(light_idx, hit.point))
+                    continue;
+
+                const LightEntry &light = lights.at(light_idx);
+                float weight = 1.0f / (pdf * options.light_samples);
+
+                if (light.plight != nullptr)
+                    queuePointLightRay(shadow_rays, p, path, light.plight,
+                                       1, weight);
+                else
+                    queueSquareLightRays(shadow_rays, p, path, light.slight,
+                                         options, 1, weight);
+            }
+        } else if (options.light_cutoff > 0) {
+            lights.getInfluencingLights(hit.point, queues.nearby);
+
+            for (int light_idx : queues.nearby) {
+                const LightEntry &light = lights.at(light_idx);
+
+                if (light.plight != nullptr)
+                    queuePointLightRay(shadow_rays, p, path, light.plight,
+                                       1, 1);
+                else
+                    queueSquareLightRays(shadow_rays, p, path, light.slight,
+                                         options, 1, 1);
+            }
+        } else {
+            for (PointLight *light : plights)
+                queuePointLightRay(shadow_rays, p, path, light, 0, 1);
+
+            for (SquareLight *light : slights)
+                queueSquareLightRays(shadow_rays, p, path, light, options,
+                                     1, 1);
+        }
+    }
+}
+
+/**
+ * @name    traceShadowRays
+ * @brief   Tests every queued shadow ray for occlusion.
+ *
+ * @tparam MODE  - @see README.md - Run Modes
+ *
+ * @details The rays from one square light to one hit are traced as packets
+ * (@see RayPacket), the rest one by one.
+ */
+template <int MODE>
+void Camera::traceShadowRays(const BVHTree &surfaces,
+                             WavefrontQueues &queues) const {
+    vector<ShadowRay> &shadow_rays = queues.shadow_rays;
+    size_t r = 0;
+
+    while (r < shadow_rays.size()) {
+        ShadowRay &first = shadow_rays[r];
+
+        if (MODE != -1 || first.light == nullptr) {
+            first.occluded = isIntercepted<MODE>(surfaces, first.ray,
+                                                 first.ray.t_max);
+            r++;
+            continue;
+        }
+
+        RayPacket packet;
+        Point corners[4];
+        size_t end = r;
+
+        while (packet.size < RAY_PACKET_SIZE) {
+            packet.add(shadow_rays[end].ray);
+
+            if (shadow_rays[end++].last)
+                break;
+        }
+
+        first.light->getCorners(corners);
+        packet.setFrustum(queues.paths[first.path].hit.point, corners);
+
+        unsigned int occluded = surfaces.getOcclusionMask(packet);
+
+        for (size_t k = r; k < end; k++)
+            shadow_rays[k].occluded = (occluded & (1u << (k - r))) != 0;
+
+        r = end;
+    }
+}
+
+/**
+ * @name    writeGBuffer
+ * @brief   Writes what shading needs of the hit of every path to the
+ *          G-buffer, right after the closest hits are found.
+ *
+ * @param table  - the materials of the scene; back faces are shaded with its
+ *                 back face entry.
+ */
+void Camera::writeGBuffer(const MaterialTable &table,
+                          const BVHTree &surfaces,
+                          WavefrontQueues &queues) const {
+    GBuffer &gbuffer = queues.gbuffer;
+
+    gbuffer.resize(queues.paths.size());
+
+    for (size_t p = 0; p < queues.paths.size(); p++) {
+        const PathState &path = queues.paths[p];
+        const Hit &hit = path.hit;
+
+        if (hit.surface_idx == -1) {
+            gbuffer.material[p] = -1;
+            continue;
+        }
+
+        gbuffer.px[p] = hit.point.x;
+        gbuffer.py[p] = hit.point.y;
+        gbuffer.pz[p] = hit.point.z;
+        gbuffer.nx[p] = hit.normal.i;
+        gbuffer.ny[p] = hit.normal.j;
+        gbuffer.nz[p] = hit.normal.k;
+        gbuffer.vx[p] = -path.ray.direction.i;
+        gbuffer.vy[p] = -path.ray.direction.j;
+        gbuffer.vz[p] = -path.ray.direction.k;
+        gbuffer.material[p] = hit.front_faced
+                              ? surfaces.at(hit.surface_idx)->material_idx
+                              : table.backFace();
+    }
+}
+
+/**
+ * @name    shadeLightSamples
+ * @brief   Works out the light every unoccluded shadow ray brings to the hit
+ *          of its path, as Material::phongShading would, from the G-buffer.
+ *
+ * @param table  - the materials of the scene.
+ * @param fast_pow - use the approximate pow for the highlights.
+ *
+ * @details The unoccluded shadow rays of the queue, for every light and
+ * every path of the tile, are taken in chunks of SHADING_CHUNK_SIZE. Each
+ * chunk is first joined with the G-buffer entries of its paths into a
+ * structure of arrays, over which the Phong model then runs in a few
+ * passes of the active Kernels.
+ */
+void Camera::shadeLightSamples(const MaterialTable &table, bool fast_pow,
+                               WavefrontQueues &queues) const {
+    const vector<ShadowRay> &shadow_rays = queues.shadow_rays;
+    const GBuffer &gbuffer = queues.gbuffer;
+    LightSamples &s = queues.light_samples;
+    size_t next = 0;
+
+    s.shades.clear();
+
+    while (next < shadow_rays.size()) {
+        int count = 0;
+
+        for (; next < shadow_rays.size() && count < SHADING_CHUNK_SIZE;
+               next++) {
+            const ShadowRay &shadow = shadow_rays[next];
+
+            if (shadow.occluded)
+                continue;
+
+            int p = shadow.path;
+            int m = gbuffer.material[p];
+            int r = count++;
+
+            s.dx[r] = shadow.ray.origin.x - gbuffer.px[p];
+            s.dy[r] = shadow.ray.origin.y - gbuffer.py[p];
+            s.dz[r] = shadow.ray.origin.z - gbuffer.pz[p];
+            s.nx[r] = gbuffer.nx[p];
+            s.ny[r] = gbuffer.ny[p];
+            s.nz[r] = gbuffer.nz[p];
+            s.ix[r] = -shadow.ray.direction.i;
+            s.iy[r] = -shadow.ray.direction.j;
+            s.iz[r] = -shadow.ray.direction.k;
+            s.hx[r] = gbuffer.vx[p] + s.ix[r];
+            s.hy[r] = gbuffer.vy[p] + s.iy[r];
+            s.hz[r] = gbuffer.vz[p] + s.iz[r];
+            s.light_r[r] = shadow.light_color.r;
+            s.light_g[r] = shadow.light_color.g;
+            s.light_b[r] = shadow.light_color.b;
+            s.material[r] = m;
+            s.diffuse_r[r] = table.diffuse_r[m];
+            s.diffuse_g[r] = table.diffuse_g[m];
+            s.diffuse_b[r] = table.diffuse_b[m];
+            s.specular_r[r] = table.specular_r[m];
+            s.specular_g[r] = table.specular_g[m];
+            s.specular_b[r] = table.specular_b[m];
+            s.phong[r] = table.phong[m];
+            s.has_specular[r] = table.has_specular[m];
+        }
+
+        Kernels::active->shadeLightSamples(s, count, fast_pow);
+
+        for (int r = 0; r < count; r++)
+            s.shades.push_back(RGB(s.r[r], s.g[r], s.b[r]));
+    }
+}
+
+/**
+ * @name    shadePaths
+ * @brief   Shades the hit of every path with the light brought by its
+ *          unoccluded shadow rays, and adds it to the shade of its primary
+ *          sample.
+ *
+ * @param depth - the number of surfaces the paths have bounced off; the
+ *                ambient light is only added to the hits of primary rays.
+ * @param deferred - the light of the shadow rays has already been worked
+ *                out by shadeLightSamples.
+ *
+ * @see getShadeAlongRay for the rest of the parameters.
+ */
+void Camera::shadePaths(const vector<Material> &materials,
+                        const AmbientLight &ambient,
+                        const BVHTree &surfaces, int depth, bool deferred,
+                        WavefrontQueues &queues) const {
+    const LightSamples &samples = queues.light_samples;
+    RGB light_shade(0, 0, 0);
+    int lit = 0;
+
+    for (const ShadowRay &shadow : queues.shadow_rays) {
+        PathState &path = queues.paths[shadow.path];
+
+        if (!shadow.occluded && deferred) {
+            light_shade.add(samples.shades[lit++]);
+        } else if (!shadow.occluded) {
+            const Material &material =
+                    materials[surfaces.at(path.hit.surface_idx)->material_idx];
+
+            light_shade.add(material.phongShading(shadow.light_color,
+                                                  shadow.ray, path.ray,
+                                                  path.hit));
+        }
+
+        if (shadow.last) {
+            path.direct[shadow.sum].addTimes(light_shade, shadow.scale);
+            light_shade = RGB(0, 0, 0);
+        }
+    }
+
+    for (const PathState &path : queues.paths) {
+        if (path.hit.surface_idx == -1)
+            continue;
+
+        const Material &material =
+                materials[surfaces.at(path.hit.surface_idx)->material_idx];
+
+        RGB local(0, 0, 0);
+        local.add(path.direct[0]);
+        local.add(path.direct[1]);
+
+        if (depth == 0)
+            local.add(material.diffuse.scaleRGB(ambient.color));
+
+        queues.shades[path.sample].add(local.scaleRGB(path.throughput));
+    }
+}
+
+/**
+ * @name    reflectPaths
+ * @brief   Replaces the queue of paths with the paths reflected off their
+ *          hits.
+ *
+ * @details A path is continued exactly when getShadeAlongRay would follow
+ * its reflection: it hit the front face of a reflective surface and its
+ * throughput is still large enough (and it survives Russian roulette).
+ *
+ * @see getShadeAlongRay for the parameters.
+ */
+void Camera::reflectPaths(const vector<Material> &materials,
+                          const BVHTree &surfaces,
+                          const RenderOptions &options,
+                          WavefrontQueues &queues) const {
+    queues.reflected.clear();
+
+    for (const PathState &path : queues.paths) {
+        const Ray &ray = path.ray;
+        const Hit &hit = path.hit;
+
+        if (hit.surface_idx == -1)
+            continue;
+
+        const Material &material =
+                materials[surfaces.at(hit.surface_idx)->material_idx];
+
+        if (!material.reflective || !hit.front_faced)
+            continue;
+
+        RGB throughput = path.throughput.scaleRGB(material.ideal_specular);
+
+        float strength = throughput.maxComponent();
+
+        if (strength < options.throughput_epsilon)
+            continue;
+
+        if (strength < options.roulette) {
+            float survival = strength / options.roulette;
+
+            if (rand() / (RAND_MAX + 1.0) >= survival)
+                continue;
+
+            throughput = throughput.times(1 / survival);
+        }
+
+        float cos_i = ray.direction.dot(hit.normal);
+        Vector reflected_vector = ray.direction
+                .plusTimes(hit.normal, -2 * cos_i)
+                .norm();
+
+        Ray reflected_ray(hit.point, reflected_vector);
+        reflected_ray.cone_width = ray.getFootprint(hit.t);
+        reflected_ray.cone_spread = ray.cone_spread;
+
+        queues.reflected.push_back(PathState(path.sample, reflected_ray,
+                                             throughput, path.window));
+    }
+
+    queues.paths.swap(queues.reflected);
+}
+
+/**
+ * @brief   Spreads the lower 9 bits of x out to every third bit, to
+ *          interleave three co-ordinates into a Morton code.
+ */
+static unsigned int spreadBits(unsigned int x) {
+    x &= 0x1ff;
+    x = (x | (x << 16)) & 0x030000ff;
+    x = (x | (x << 8)) & 0x0300f00f;
+    x = (x | (x << 4)) & 0x030c30c3;
+    x = (x | (x << 2)) & 0x09249249;
+    return x;
+}
+
+/**
+ * @name    sortPaths
+ * @brief   Orders the queue of paths so that paths with similar rays are
+ *          traced one after the other.
+ *
+ * @details The paths are sorted by the octant of their direction, and
+ * within an octant along a Morton curve over the cells (a 512^3 grid over
+ * the bounds of the queue) of their origin. Rays with the same direction
+ * signs from nearby points mostly visit the same BVHTree nodes in the same
+ * order, so they find those nodes (and the surfaces in them) in the cache.
+ * Each path still adds to the shade of its own primary sample, so the image
+ * doesn't depend on the order.
+ */
+static void sortPaths(WavefrontQueues &queues) {
+    vector<PathState> &paths = queues.paths;
+    vector<pair<unsigned int, int> > &keys = queues.keys;
+
+    if (paths.size() < 2)
+        return;
+
+    Point lo = paths[0].ray.origin, hi = lo;
+
+    for (const PathState &path : paths) {
+        const Point &o = path.ray.origin;
+
+        lo = Point(fminf(lo.x, o.x), fminf(lo.y, o.y), fminf(lo.z, o.z));
+        hi = Point(fmaxf(hi.x, o.x), fmaxf(hi.y, o.y), fmaxf(hi.z, o.z));
+    }
+
+    Vector extent = hi.sub(lo);
+    Vector scale(extent.i > 0 ? 511 / extent.i : 0,
+                 extent.j > 0 ? 511 / extent.j : 0,
+                 extent.k > 0 ? 511 / extent.k : 0);
+
+    keys.clear();
+
+    for (int p = 0; p < (int) paths.size(); p++) {
+        const Ray &ray = paths[p].ray;
+        Vector cell = ray.origin.sub(lo);
+
+        unsigned int octant = (unsigned int) (ray.sign[0] |
+                                              ray.sign[1] << 1 |
+                                              ray.sign[2] << 2);
+        unsigned int morton =
+                spreadBits((unsigned int) (cell.i * scale.i)) |
+                spreadBits((unsigned int) (cell.j * scale.j)) << 1 |
+                spreadBits((unsigned int) (cell.k * scale.k)) << 2;
+
+        keys.push_back(make_pair(octant << 27 | morton, p));
+    }
+
+    sort(keys.begin(), keys.end());
+
+    queues.reflected.clear();
+    for (const pair<unsigned int, int> &key : keys)
+        queues.reflected.push_back(paths[key.second]);
+
+    paths.swap(queues.reflected);
+}
+
+/**
+ * @name    renderWavefront
+ * @brief   Renders the image with the wavefront renderer.
+ *
+ * @param width | @param height - the size of the image plane.
+ * @param sample_spread - angle subtended by a single pixel sample at the eye.
+ * @param predictor     - predicts the hits of primary rays.
+ * @param progress      - reports the pixels done.
+ * @param stats         - counts the work of tracing rays.
+ * @tparam MODE         - @see README.md - Run Modes
+ *
+ * @details The image is taken in square tiles of about WAVEFRONT_BATCH_SIZE
+ * primary samples. The paths of a tile go through the stages together, one
+ * bounce at a time, until all of them have left the scene, stopped
+ * reflecting or reached options.max_depth.
+ *
+ * The primary rays of a tile lie within the frustum from the eye through the
+ * tile, so their searches start at the node of the BVHTree below which all
+ * that the frustum reaches lies, and a tile whose frustum reaches nothing is
+ * left as background without tracing a ray.
+ *
+ * With options.packets the primary rays are traced in packets of a block of
+ * pixels, and with options.sort_rays the reflected rays of the tile are
+ * sorted before they are traced. With options.raster (and acceleration) the
+ * primary hits are not traced at all but taken from a visibility buffer
+ * rasterized up front, leaving the BVHTree to shadow and reflected rays.
+ * With options.deferred the hits are written to a G-buffer and shaded from
+ * it by a separate pass over all shadow rays of the tile.
+ */
+template <int MODE>
+void Camera::renderWavefront(Array2D <Rgba> &pixels,
+                             const vector<Material> &materials,
+                             const vector<PointLight *> &plights,
+                             const vector<SquareLight *> &slights,
+                             const LightTree &lights,
+                             const AmbientLight &ambient,
+                             const BVHTree &surfaces,
+                             const RenderOptions &options,
+                             float width, float height,
+                             float sample_spread,
+                             HitPredictor &predictor,
+                             ProgressBar &progress,
+                             WavefrontStats &stats) const {
+    int p_samples = options.p_samples;
+    int pixels_done = 0;
+    WavefrontQueues queues;
+    VisibilityBuffer buffer;
+    MaterialTable table(materials);
+
+    /* The largest tile (of whole blocks) within the batch size */
+    int tile = PACKET_BLOCK_SIZE;
+    while (tile < WAVEFRONT_MAX_TILE_SIZE &&
+           4 * tile * tile * p_samples <= WAVEFRONT_BATCH_SIZE)
+        tile *= 2;
+
+    /* Packets are traced through the BVHTree */
+    bool packets = options.packets && MODE != 0;
+
+    /* The primary hits are found by rasterizing, not tracing */
+    bool raster = options.raster && MODE == -1;
+
+    if (raster) {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+        buffer.build(*this, surfaces, options);
+
+        stats.raster_time = chrono::duration<double>(
+                chrono::steady_clock::now() - start).count();
+        stats.raster_primitives = (long) buffer.primitiveCount();
+        stats.raster_threads = buffer.threadCount();
+    }
+
+    for (int y0 = 0; y0 < this->ph; y0 += tile) {
+        for (int x0 = 0; x0 < this->pw; x0 += tile) {
+            int x1 = min(x0 + tile, this->pw);
+            int y1 = min(y0 + tile, this->ph);
+            const BVHNode *entry = nullptr;
+
+            stats.tiles++;
+
+            /* The primary rays of the tile all lie in this frustum */
+            if (MODE != 0) {
+                Point corners[4] = {
+                        getPixelSample(x0, y0, width, height, 0, 0),
+                        getPixelSample(x1, y0, width, height, 0, 0),
+                        getPixelSample(x1, y1, width, height, 0, 0),
+                        getPixelSample(x0, y1, width, height, 0, 0)};
+                int depth;
+
+                entry = surfaces.getEntryNode(
+                        Frustum(this->eye, corners, false), depth);
+
+                if (entry == nullptr)
+                    stats.tiles_missed++;
+                else
+                    stats.entry_depth += depth;
+            }
+
+            /* Nothing to trace, the tile is all background */
+            if (MODE != 0 && entry == nullptr) {
+                for (int i = y0; i < y1; i++) {
+                    for (int j = x0; j < x1; j++) {
+                        Rgba &px = pixels[i][j];
+                        px.r = px.g = px.b = 0;
+                        px.a = 1;
+                    }
+                }
+
+                pixels_done += (x1 - x0) * (y1 - y0);
+                progress.log(pixels_done, this->pw * this->ph);
+                continue;
+            }
+
+            generatePrimaryRays(x0, y0, x1, y1, width, height,
+                                sample_spread, options,
+                                raster ? &buffer : nullptr, queues);
+
+            for (int depth = 0; depth < options.max_depth &&
+                                !queues.paths.empty(); depth++) {
+                if (depth > 0 && options.sort_rays)
+                    sortPaths(queues);
+
+                long nodes_visited = surfaces.nodes_visited;
+                clock_t start = clock();
+
+                if (depth == 0 && raster)
+                    findClosestHitsInBuffer(surfaces, buffer, x0, y0, x1,
+                                            p_samples, queues.paths,
+                                            stats.raster_traced);
+                else if (depth == 0 && packets)
+                    findClosestHitsInPackets<MODE>(surfaces, queues.paths,
+                                                   entry);
+                else if (depth == 0)
+                    findClosestHits<MODE>(surfaces, queues.paths, &predictor,
+                                          entry);
+                else
+                    findClosestHits<MODE>(surfaces, queues.paths, nullptr,
+                                          nullptr);
+
+                if (depth == 0) {
+                    stats.primary_time += clock() - start;
+                    stats.primary_nodes_visited +=
+                            surfaces.nodes_visited - nodes_visited;
+                    stats.primary_rays += queues.paths.size();
+                } else {
+                    stats.time += clock() - start;
+                    stats.nodes_visited +=
+                            surfaces.nodes_visited - nodes_visited;
+                    stats.reflected_rays += queues.paths.size();
+                }
+
+                if (options.deferred)
+                    writeGBuffer(table, surfaces, queues);
+
+                castShadowRays(materials, plights, slights, lights, surfaces,
+                               options, queues);
+                traceShadowRays<MODE>(surfaces, queues);
+
+                if (options.deferred)
+                    shadeLightSamples(table, options.fast_pow, queues);
+
+                shadePaths(materials, ambient, surfaces, depth,
+                           options.deferred, queues);
+                reflectPaths(materials, surfaces, options, queues);
+            }
+
+            for (int i = y0; i < y1; i++) {
+                for (int j = x0; j < x1; j++) {
+                    int pixel = (i - y0) * (x1 - x0) + (j - x0);
+                    RGB shade(0, 0, 0);
+
+                    for (int k = 0; k < p_samples; k++)
+                        shade.add(queues.shades[pixel * p_samples + k]);
+
+                    shade = shade.times(1.0f / p_samples);
+
+                    Rgba &px = pixels[i][j];
+                    px.r = shade.r;
+                    px.g = shade.g;
+                    px.b = shade.b;
+                    px.a = 1;
+                }
+            }
+
+            pixels_done += (x1 - x0) * (y1 - y0);
+            progress.log(pixels_done, this->pw * this->ph);
+        }
+    }
+}
+
+/* The wavefront renderer for every run mode, which Camera::render picks from */
+template void Camera::renderWavefront<-1>(
+        Array2D <Rgba> &, const vector<Material> &,
+        const vector<PointLight *> &, const vector<SquareLight *> &,
+        const LightTree &, const AmbientLight &, const BVHTree &,
+        const RenderOptions &, float, float, float, HitPredictor &,
+        ProgressBar &, WavefrontStats &) const;
+template void Camera::renderWavefront<0>(
+        Array2D <Rgba> &, const vector<Material> &,
+        const vector<PointLight *> &, const vector<SquareLight *> &,
+        const LightTree &, const AmbientLight &, const BVHTree &,
+        const RenderOptions &, float, float, float, HitPredictor &,
+        ProgressBar &, WavefrontStats &) const;
+template void Camera::renderWavefront<1>(
+        Array2D <Rgba> &, const vector<Material> &,
+        const vector<PointLight *> &, const vector<SquareLight *> &,
+        const LightTree &, const AmbientLight &, const BVHTree &,
+        const RenderOptions &, float, float, float, HitPredictor &,
+        ProgressBar &, WavefrontStats &) const;
@@ -0,0 +1,127 @@
+//
+// Created by agent on 10/19/26.
+//
+
+/**
+ * Measures how many ray / bounding box tests are done per second by the
+ * slab test in BoundingBox::getIntersection, against the previous kernel that
+ * divided by the ray direction and branched on its sign for every box.
+ *
+ * Build and run with `make bench`.
+ */
+
+#include <chrono>
+#include <limits>
+#include <vector>
+#include "../include/BoundingBox.h"
+
+using namespace std;
+
+static const int N_BOXES = 1024;
+static const int N_RAYS = 1024;
+static const int N_ROUNDS = 20;
+
+/*
+ * The kernel BoundingBox::getIntersection used before rays carried their
+ * reciprocal direction, kept here as the baseline.
+ */
+static float divisionSlabTest(const BoundingBox &box, const Ray &ray) {
+    float t_x_min, t_x_max, t_y_min, t_y_max, t_z_min, t_z_max;
+    float t_min = 0;
+    float t_max = numeric_limits<float>::infinity();
+
+    if (ray.direction.i == 0 &&
+        (ray.origin.x < box.x_min || ray.origin.x > box.x_max))
+        return -1;
+
+    t_x_min = (box.x_min - ray.origin.x) / ray.direction.i;
+    t_x_max = (box.x_max - ray.origin.x) / ray.direction.i;
+
+    if (ray.direction.i < 0) swap(t_x_min, t_x_max);
+
+    t_min = fmaxf(t_min, t_x_min);
+    t_max = fminf(t_max, t_x_max);
+
+    if (ray.direction.j == 0 &&
+        (ray.origin.y < box.y_min || ray.origin.y > box.y_max))
+        return -1;
+
+    t_y_min = (box.y_min - ray.origin.y) / ray.direction.j;
+    t_y_max = (box.y_max - ray.origin.y) / ray.direction.j;
+
+    if (ray.direction.j < 0) swap(t_y_min, t_y_max);
+
+    if (t_y_min > t_max) return -1;
+
+    t_min = fmaxf(t_min, t_y_min);
+    t_max = fminf(t_max, t_y_max);
+
+    if (ray.direction.k == 0 &&
+        (ray.origin.z < box.z_min || ray.origin.z > box.z_max))
+        return -1;
+
+    t_z_min = (box.z_min - ray.origin.z) / ray.direction.k;
+    t_z_max = (box.z_max - ray.origin.z) / ray.direction.k;
+
+    if (ray.direction.k < 0) swap(t_z_min, t_z_max);
+
+    t_min = fmaxf(t_min, t_z_min);
+    t_max = fminf(t_max, t_z_max);
+
+    return (t_min > t_max) ? -1 : t_min;
+}
+
+static float random(float lo, float hi) {
+    return lo + (hi - lo) * ((float) rand() / RAND_MAX);
+}
+
+template<typename Kernel>
+static void run(const char *name, const vector<BoundingBox> &boxes,
+                const vector<Ray> &rays, Kernel kernel) {
+    long hits = 0;
+    auto start = chrono::steady_clock::now();
+
+    for (int round = 0; round < N_ROUNDS; round++)
+        for (const Ray &ray : rays)
+            for (const BoundingBox &box : boxes)
+                hits += kernel(box, ray) != -1;
+
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    double tests = (double) N_ROUNDS * rays.size() * boxes.size();
+
+    cout << name << ": " << tests / elapsed.count() / 1e6
+         << " M box tests/s (" << hits << " hits)" << endl;
+}
+
+int main() {
+    vector<BoundingBox> boxes;
+    vector<Ray> rays;
+
+    srand(1);
+
+    for (int i = 0; i < N_BOXES; i++) {
+        float x = random(-50, 50), y = random(-50, 50), z = random(-50, 50);
+        float size = random(1, 10);
+
+        boxes.push_back(BoundingBox(x, x + size, y, y + size, z, z + size));
+    }
+
+    /* Every 8th ray is parallel to an axis */
+    for (int i = 0; i < N_RAYS; i++) {
+        Point origin(random(-80, 80), random(-80, 80), random(-80, 80));
+        Vector direction(random(-1, 1), random(-1, 1), random(-1, 1));
+
+        if (i % 8 == 0)
+            direction = Vector(0, 0, 1);
+
+        rays.push_back(Ray(origin, direction.norm()));
+    }
+
+    run("division slab test", boxes, rays, divisionSlabTest);
+    run("reciprocal slab test", boxes, rays,
+        [](const BoundingBox &box, const Ray &ray) -> float {
+            return box.getIntersection(ray);
+        });
+
+    return 0;
+}
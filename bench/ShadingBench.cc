@@ -0,0 +1,227 @@
+//
+// Created by agent on 10/19/26.
+//
+
+/**
+ * Measures how many light samples per second go through the vector math of
+ * the Camera shading path (aiming a light ray at a sample on a square light
+ * and shading the hit with Material::phongShading, step for step) with
+ * Vector, Point and RGB kept in Float4 lanes, against the scalar classes
+ * they used to be. Also tries normalizing with the reciprocal square root
+ * estimate of the processor instead of a square root and a division.
+ *
+ * Build and run with `make bench`.
+ */
+
+#include <chrono>
+#include <vector>
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+#include "../include/Vector.h"
+#include "../include/Point.h"
+#include "../include/RGB.h"
+#include "../include/FastMath.h"
+
+using namespace std;
+
+static const int N_HITS = 4096;
+static const int N_SAMPLES = 64;
+static const int N_ROUNDS = 20;
+
+/*
+ * The scalar Vector, Point and RGB, component by component, kept here as
+ * the baseline.
+ */
+class ScalarVector {
+public:
+    float i, j, k;
+
+    ScalarVector() : i(0), j(0), k(0) {};
+
+    ScalarVector(float i, float j, float k) : i(i), j(j), k(k) {};
+
+    inline float mag() const {
+        return sqrtf(powf(i, 2.0) + powf(j, 2.0) + powf(k, 2.0));
+    };
+
+    inline ScalarVector norm() const {
+        float mag = this->mag();
+        return ScalarVector(i / mag, j / mag, k / mag);
+    };
+
+    inline ScalarVector times(float c) const {
+        return ScalarVector(i * c, j * c, k * c);
+    };
+
+    inline float dot(const ScalarVector &vec) const {
+        return i * vec.i + j * vec.j + k * vec.k;
+    };
+
+    inline ScalarVector plus(const ScalarVector &vec) const {
+        return ScalarVector(i + vec.i, j + vec.j, k + vec.k);
+    };
+
+    inline ScalarVector operator-() const {
+        return ScalarVector(-i, -j, -k);
+    };
+};
+
+class ScalarPoint {
+public:
+    float x, y, z;
+
+    ScalarPoint() : x(0), y(0), z(0) {};
+
+    ScalarPoint(float x, float y, float z) : x(x), y(y), z(z) {};
+
+    inline ScalarVector sub(const ScalarPoint &p) const {
+        return ScalarVector(x - p.x, y - p.y, z - p.z);
+    };
+
+    inline ScalarPoint moveAlong(const ScalarVector &vec) const {
+        return ScalarPoint(x + vec.i, y + vec.j, z + vec.k);
+    };
+
+    inline float distance2(const ScalarPoint &p) const {
+        return powf(x - p.x, 2.0) + powf(y - p.y, 2.0) + powf(z - p.z, 2.0);
+    };
+};
+
+class ScalarRGB {
+public:
+    float r, g, b;
+
+    ScalarRGB() : r(0), g(0), b(0) {};
+
+    ScalarRGB(float r, float g, float b) : r(r), g(g), b(b) {};
+
+    inline void add(const ScalarRGB shade) {
+        r += shade.r;
+        g += shade.g;
+        b += shade.b;
+    };
+
+    inline ScalarRGB scaleRGB(const ScalarRGB shade) const {
+        return ScalarRGB(r * shade.r, g * shade.g, b * shade.b);
+    };
+
+    inline ScalarRGB times(float c) const {
+        return ScalarRGB(r * c, g * c, b * c);
+    };
+};
+
+/*
+ * Normalization by the reciprocal square root estimate (rsqrtss, good to 12
+ * bits) refined by one Newton-Raphson step to about 2e-7 relative.
+ */
+static Vector rsqrtNorm(const Vector &vec) {
+    float mag2 = vec.dot(vec);
+#if defined(__SSE__)
+    float y = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(mag2)));
+#else
+    float y = 1 / sqrtf(mag2);
+#endif
+
+    return vec.times(y * (1.5f - 0.5f * mag2 * y * y));
+}
+
+/* A shading point: its position, normal and the vector to the viewer */
+template<typename V, typename P>
+struct ShadingPoint {
+    P point;
+    V normal, view;
+};
+
+static float random(float lo, float hi) {
+    return lo + (hi - lo) * ((float) rand() / RAND_MAX);
+}
+
+/**
+ * Shades every hit from every sample on a square light, as
+ * Camera::sampleSquareLight and Material::phongShading do (without the
+ * shadow rays), with the given types and normalization.
+ */
+template<typename V, typename P, typename C, typename Norm>
+static void run(const char *name, const vector<ShadingPoint<V, P> > &hits,
+                const vector<float> &samples, Norm norm) {
+    P center(0, 10, 0);
+    V u(1, 0, 0), v(0, 0, 1), w(0, -1, 0);
+    C light_color(1, 0.9f, 0.8f), diffuse(0.6f, 0.5f, 0.4f);
+    C specular(0.3f, 0.3f, 0.3f);
+
+    C total;
+    auto start = chrono::steady_clock::now();
+
+    for (int round = 0; round < N_ROUNDS; round++) {
+        for (const ShadingPoint<V, P> &hit : hits) {
+            for (size_t s = 0; s < samples.size(); s += 2) {
+                P sample = center.moveAlong(u.times(samples[s]))
+                        .moveAlong(v.times(samples[s + 1]));
+
+                V direction = norm(hit.point.sub(sample));
+                C color = light_color.times(fmaxf(0, direction.dot(w)));
+
+                float d2 = fmaxf(1, sample.distance2(hit.point));
+                V I = -direction;
+
+                float diffuse_factor = fmaxf(0, hit.normal.dot(I));
+                V bisector = norm(hit.view.plus(I));
+                float specular_factor =
+                        fastPow(fmaxf(0, hit.normal.dot(bisector)), 20);
+
+                total.add(diffuse.times(diffuse_factor)
+                                  .scaleRGB(color).times(1 / d2));
+                total.add(specular.times(specular_factor)
+                                  .scaleRGB(color).times(1 / d2));
+            }
+        }
+    }
+
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    double shades = (double) N_ROUNDS * hits.size() * samples.size() / 2;
+
+    cout << name << ": " << shades / elapsed.count() / 1e6
+         << " M light samples/s (total " << total.r + total.g + total.b
+         << ")" << endl;
+}
+
+int main() {
+    vector<ShadingPoint<ScalarVector, ScalarPoint> > scalar_hits;
+    vector<ShadingPoint<Vector, Point> > hits;
+    vector<float> samples;
+
+    srand(1);
+
+    for (int h = 0; h < N_HITS; h++) {
+        float x = random(-5, 5), z = random(-5, 5);
+        float ni = random(-0.3f, 0.3f), nk = random(-0.3f, 0.3f);
+        float vi = random(-1, 1), vk = random(-1, 1);
+
+        ShadingPoint<Vector, Point> hit;
+        hit.point = Point(x, 0, z);
+        hit.normal = Vector(ni, 1, nk).norm();
+        hit.view = Vector(vi, 1, vk).norm();
+        hits.push_back(hit);
+
+        ShadingPoint<ScalarVector, ScalarPoint> scalar_hit;
+        scalar_hit.point = ScalarPoint(x, 0, z);
+        scalar_hit.normal = ScalarVector(ni, 1, nk).norm();
+        scalar_hit.view = ScalarVector(vi, 1, vk).norm();
+        scalar_hits.push_back(scalar_hit);
+    }
+
+    for (int s = 0; s < 2 * N_SAMPLES; s++)
+        samples.push_back(random(-1, 1));
+
+    run<ScalarVector, ScalarPoint, ScalarRGB>(
+            "scalar", scalar_hits, samples,
+            [](const ScalarVector &vec) { return vec.norm(); });
+    run<Vector, Point, RGB>(
+            "Float4", hits, samples,
+            [](const Vector &vec) { return vec.norm(); });
+    run<Vector, Point, RGB>(
+            "Float4 with rsqrt", hits, samples, rsqrtNorm);
+
+    return 0;
+}
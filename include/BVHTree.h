@@ -7,8 +7,10 @@
 
 
 #include <functional>
+#include <limits>
 #include "Surface.h"
 #include "BoundingBox.h"
+#include "RayPacket.h"
 
 class BVHNode {
 public:
@@ -30,6 +32,36 @@ public:
     };
 };
 
+/**
+ * Remembers the primitive hit by the previous primary ray so that the next
+ * one, which usually hits the same primitive, can test it first and start
+ * its search of the BVHTree with a tight bound. The render keeps one, as it
+ * traces the primary rays one after another on a single thread.
+ */
+class HitPredictor {
+public:
+    /* The previous hit, nullptr if it missed */
+    int surface_idx;
+    const Surface *primitive;
+
+    /* Rays searched and rays whose closest hit was the predicted one */
+    long searches, predicted;
+
+    HitPredictor() {
+        this->surface_idx = -1;
+        this->primitive = nullptr;
+        this->searches = 0;
+        this->predicted = 0;
+    };
+};
+
+/**
+ * A bounding volume hierarchy over the surfaces of a scene.
+ *
+ * The searches are templates over the run mode (@see README.md - Run Modes)
+ * so that each mode gets a traversal of its own, with the test of the mode
+ * at every leaf resolved at compile time.
+ */
 class BVHTree {
 private:
     BVHNode *root;
@@ -38,18 +70,31 @@ private:
     BVHNode *_makeBVHTree(std::vector<BoundingBox *> &bboxes, int start,
                           int end, int axis) const;
 
+    template <int MODE>
     bool _isIntercepted(const BVHNode *node, const Ray &ray,
-                        float t_max, int mode) const;
+                        float t_max) const;
+
+    void _getOcclusionMask(const BVHNode *node, const RayPacket &packet,
+                           unsigned int active, unsigned int &occluded) const;
 
-    std::tuple<int, float>
-    _getClosestSurface(const BVHNode *node, const Ray &ray,
-                       int mode, const std::tuple<int, float> &closest) const;
+    template <int MODE>
+    void _getClosestSurface(const BVHNode *node, const Ray &ray,
+                            Hit &closest) const;
+
+    template <int MODE>
+    void _getClosestSurfaces(const BVHNode *node, const RayPacket &packet,
+                             unsigned int active, Hit *closest) const;
 
     void printTree(BVHNode *node) const;
 
     int _getMaxHeight(BVHNode *node) const;
 
 public:
+    /*
+     * Number of nodes visited by closest hit searches, to measure the cost
+     * of traversal. Not synchronized; the searches run on a single thread.
+     */
+    mutable long nodes_visited;
 
     BVHTree(const std::vector<Surface *> *surfaces);
 
@@ -59,11 +104,27 @@ public:
 
     Surface *at(int index) const;
 
-    int makeBVHTree();
+    int makeBVHTree(bool verbose = true);
+
+    template <int MODE>
+    bool isIntercepted(const Ray &ray, float t_max) const;
+
+    unsigned int getOcclusionMask(const RayPacket &packet) const;
+
+    template <int MODE>
+    Hit getClosestSurface(const Ray &ray,
+                          float t_max = std::numeric_limits<float>::infinity())
+            const;
+
+    template <int MODE>
+    Hit getClosestSurface(const Ray &ray, HitPredictor &predictor,
+                          const BVHNode *entry = nullptr) const;
 
-    bool isIntercepted(const Ray &ray, float t_max, int mode) const;
+    template <int MODE>
+    void getClosestSurfaces(const RayPacket &packet, Hit *closest,
+                            const BVHNode *entry = nullptr) const;
 
-    std::tuple<int, float> getClosestSurface(const Ray &ray, int mode) const;
+    const BVHNode *getEntryNode(const Frustum &frustum, int &depth) const;
 
     bool isEmpty() const;
 
@@ -10,48 +10,232 @@
 #include "Surface.h"
 #include "Light.h"
 #include "BVHTree.h"
+#include "LightTree.h"
+#include "RenderOptions.h"
+#include "Wavefront.h"
+#include "VisibilityBuffer.h"
+#include "ProgressBar.h"
 #include <ImfRgba.h>
 #include <ImfArray.h>
 
 using namespace std;
 using namespace Imf;
 
-static const int RECURSIVE_LIMIT = 20;
+/* Number of probe samples for adaptive area shadows */
+static const int ADAPTIVE_PROBE_SAMPLES = 4;
 
 class Camera {
 private:
+    static SampleWindow shadowWindow(unsigned int seed, int k, int p_samples,
+                                     const RenderOptions &options);
+
     Point getPixelSample(int i, int j,
                          float width, float height,
-                         int p, int q, int strata) const;
+                         float x_d, float y_d) const;
+
+    template <int MODE>
+    Hit getClosestSurface(const BVHTree &surfaces, const Ray &ray,
+                          HitPredictor *predictor = nullptr,
+                          const BVHNode *entry = nullptr) const;
 
-    tuple<int, float> getClosestSurface(const BVHTree &surfaces,
-                                        const Ray &ray, int mode) const;
+    template <int MODE>
+    void resolveHit(const BVHTree &surfaces, const Ray &ray,
+                    Hit &hit) const;
 
+    template <int MODE>
     bool isIntercepted(const BVHTree &surfaces,
-                       const Ray &ray, float t_max, int mode) const;
+                       const Ray &ray, float t_max) const;
+
+    template <int MODE>
+    RGB shadeFromPointLight(const PointLight *light,
+                            const BVHTree &surfaces,
+                            const Material &material,
+                            const Ray &view_ray,
+                            const Hit &hit) const;
+
+    template <int MODE>
+    bool sampleSquareLight(const SquareLight *light,
+                           const BVHTree &surfaces,
+                           const Material &material,
+                           const Ray &view_ray,
+                           const Hit &hit,
+                           float u_d, float v_d,
+                           RGB &shade) const;
+
+    template <int MODE>
+    int sampleSquareLightPacket(const SquareLight *light,
+                                const BVHTree &surfaces,
+                                const Material &material,
+                                const Ray &view_ray,
+                                const Hit &hit,
+                                const float *u_d, const float *v_d,
+                                int count, RGB &shade) const;
+
+    int getSquareLightSamples(const SquareLight *light, const Hit &hit,
+                              const RenderOptions &options,
+                              const SampleWindow &window,
+                              unsigned int &seed) const;
 
-    RGB diffuseFromPointLights(const vector<PointLight *> &plights,
+    template <int MODE>
+    RGB shadeFromSquareLight(const SquareLight *light,
+                             const BVHTree &surfaces,
+                             const Material &material,
+                             const Ray &view_ray,
+                             const Hit &hit,
+                             const RenderOptions &options,
+                             const SampleWindow &window) const;
+
+    template <int MODE>
+    RGB diffuseFromPointLights(const PointLightArray &plights,
                                const BVHTree &surfaces,
-                               const Surface *surface,
+                               const Material &material,
                                const Ray &view_ray,
-                               const Point &intersection,
-                               int mode) const;
+                               const Hit &hit,
+                               const RenderOptions &options) const;
 
+    template <int MODE>
     RGB diffuseFromSquareLights(const vector<SquareLight *> &slights,
                                 const BVHTree &surfaces,
-                                const Surface *surface,
+                                const Material &material,
                                 const Ray &view_ray,
-                                const Point &intersection,
-                                int mode, int s_strata) const;
+                                const Hit &hit,
+                                const RenderOptions &options,
+                                const SampleWindow &window) const;
+
+    template <int MODE>
+    RGB diffuseFromLightTree(const LightTree &lights,
+                             const BVHTree &surfaces,
+                             const Material &material,
+                             const Ray &view_ray,
+                             const Hit &hit,
+                             const RenderOptions &options,
+                             const SampleWindow &window) const;
 
+    template <int MODE>
+    RGB diffuseFromInfluencingLights(const LightTree &lights,
+                                     const BVHTree &surfaces,
+                                     const Material &material,
+                                     const Ray &view_ray,
+                                     const Hit &hit,
+                                     const RenderOptions &options,
+                                     const SampleWindow &window,
+                                     vector<int> &nearby) const;
+
+    template <int MODE>
     RGB getShadeAlongRay(const Ray &view_ray,
+                         const vector<Material> &materials,
+                         const PointLightArray &plights,
+                         const vector<SquareLight *> &slights,
+                         const LightTree &lights,
+                         const AmbientLight &ambient,
+                         const BVHTree &surfaces,
+                         const RenderOptions &options,
+                         const SampleWindow &window,
+                         HitPredictor *predictor) const;
+
+    template <int MODE>
+    RGB samplePixelAdaptively(int i, int j, float width, float height,
+                              float sample_spread,
+                              const vector<Material> &materials,
+                              const PointLightArray &plights,
+                              const vector<SquareLight *> &slights,
+                              const LightTree &lights,
+                              const AmbientLight &ambient,
+                              const BVHTree &surfaces,
+                              const RenderOptions &options,
+                              vector<int> &strata_order,
+                              HitPredictor &predictor,
+                              int &samples) const;
+
+    void generatePrimaryRays(int x0, int y0, int x1, int y1,
+                             float width, float height,
+                             float sample_spread,
+                             const RenderOptions &options,
+                             const VisibilityBuffer *buffer,
+                             WavefrontQueues &queues) const;
+
+    template <int MODE>
+    void findClosestHits(const BVHTree &surfaces,
+                         vector<PathState> &paths,
+                         HitPredictor *predictor,
+                         const BVHNode *entry) const;
+
+    template <int MODE>
+    void findClosestHitsInPackets(const BVHTree &surfaces,
+                                  vector<PathState> &paths,
+                                  const BVHNode *entry) const;
+
+    void findClosestHitsInBuffer(const BVHTree &surfaces,
+                                 const VisibilityBuffer &buffer,
+                                 int x0, int y0, int x1, int p_samples,
+                                 vector<PathState> &paths,
+                                 long &traced) const;
+
+    void queueSquareLightRays(vector<ShadowRay> &shadow_rays,
+                              int path_idx, const PathState &path,
+                              const SquareLight *light,
+                              const RenderOptions &options,
+                              int sum, float scale) const;
+
+    void castShadowRays(const vector<Material> &materials,
+                        const vector<PointLight *> &plights,
+                        const vector<SquareLight *> &slights,
+                        const LightTree &lights,
+                        const BVHTree &surfaces,
+                        const RenderOptions &options,
+                        WavefrontQueues &queues) const;
+
+    template <int MODE>
+    void traceShadowRays(const BVHTree &surfaces,
+                         WavefrontQueues &queues) const;
+
+    void writeGBuffer(const MaterialTable &table,
+                      const BVHTree &surfaces,
+                      WavefrontQueues &queues) const;
+
+    void shadeLightSamples(const MaterialTable &table, bool fast_pow,
+                           WavefrontQueues &queues) const;
+
+    void shadePaths(const vector<Material> &materials,
+                    const AmbientLight &ambient,
+                    const BVHTree &surfaces, int depth, bool deferred,
+                    WavefrontQueues &queues) const;
+
+    void reflectPaths(const vector<Material> &materials,
+                      const BVHTree &surfaces,
+                      const RenderOptions &options,
+                      WavefrontQueues &queues) const;
+
+    template <int MODE>
+    void renderWavefront(Array2D <Rgba> &pixels,
+                         const vector<Material> &materials,
                          const vector<PointLight *> &plights,
                          const vector<SquareLight *> &slights,
+                         const LightTree &lights,
                          const AmbientLight &ambient,
                          const BVHTree &surfaces,
-                         int refl_limit,
-                         int origin_surface_idx,
-                         int mode, int s_strata) const;
+                         const RenderOptions &options,
+                         float width, float height,
+                         float sample_spread,
+                         HitPredictor &predictor,
+                         ProgressBar &progress,
+                         WavefrontStats &stats) const;
+
+    template <int MODE>
+    void renderPixels(Array2D <Rgba> &pixels,
+                      const vector<Material> &materials,
+                      const vector<PointLight *> &plights,
+                      const vector<SquareLight *> &slights,
+                      const LightTree &lights,
+                      const AmbientLight &ambient,
+                      const BVHTree &surfaces,
+                      const RenderOptions &options,
+                      float width, float height,
+                      int p_samples, float sample_spread,
+                      HitPredictor &predictor,
+                      ProgressBar &progress,
+                      WavefrontStats &stats,
+                      long &total_samples) const;
 
 public:
     Point eye;
@@ -75,11 +259,11 @@ public:
 
     void render(Array2D <Rgba> &pixels,
                 const vector<Surface *> &surfaces,
-                const vector<Material *> &materials,
+                const vector<Material> &materials,
                 const vector<PointLight *> &plights,
                 const vector<SquareLight *> &slights,
                 const AmbientLight &ambient,
-                int mode, int p_strata, int s_strata) const;
+                const RenderOptions &options) const;
 };
 
 
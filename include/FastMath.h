@@ -0,0 +1,101 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#ifndef RAYTRA_FASTMATH_H
+#define RAYTRA_FASTMATH_H
+
+
+#include <cstring>
+
+/**
+ * @name fastLog2
+ * @brief the base 2 logarithm of a positive, finite x.
+ *
+ * @details The exponent of x is taken from its bits, and the logarithm of
+ * the mantissa m (in [1, 2)) from a polynomial fitted to log2(m) / (m - 1),
+ * which keeps log2(1) exact. Accurate to about 2e-7.
+ */
+inline float fastLog2(float x) {
+    int bits;
+    memcpy(&bits, &x, sizeof(bits));
+
+    float exponent = (float) ((bits >> 23) & 0xff) - 127;
+
+    bits = (bits & 0x007fffff) | 0x3f800000;
+
+    float m;
+    memcpy(&m, &bits, sizeof(m));
+
+    float t = m - 1;
+    float p = -0.012077020f;
+    p = p * t + 0.062748434f;
+    p = p * t - 0.154152006f;
+    p = p * t + 0.255176349f;
+    p = p * t - 0.353096353f;
+    p = p * t + 0.480012461f;
+    p = p * t - 0.721306757f;
+    p = p * t + 1.442694725f;
+
+    return exponent + p * t;
+}
+
+/**
+ * @name fastExp2
+ * @brief 2 raised to the power y, for y up to 127; 0 for y under -126.
+ *
+ * @details The integer part of y goes straight into the exponent bits, and
+ * 2 to the fractional part (in [0, 1)) comes from a fitted polynomial.
+ * Accurate to about 1e-7 relative.
+ */
+inline float fastExp2(float y) {
+    int whole = (int) y;
+    whole -= (y < whole) ? 1 : 0;
+
+    float f = y - whole;
+    float p = 0.001893754f;
+    p = p * f + 0.008949590f;
+    p = p * f + 0.055860337f;
+    p = p * f + 0.240141818f;
+    p = p * f + 0.693154490f;
+    p = p * f + 0.999999898f;
+
+    /* Flushed to 0 instead of going subnormal, with a mask of all 1s or 0s */
+    unsigned int bits = ((unsigned int) (whole + 127) << 23) &
+                        -(unsigned int) (whole > -127);
+    float scale;
+    memcpy(&scale, &bits, sizeof(scale));
+
+    return p * scale;
+}
+
+/**
+ * @name fastPow
+ * @brief x raised to the power p, for x in [0, 1] and p > 0, such as the
+ * cosine and the exponent of a Phong highlight; 0 for x under 0.
+ *
+ * @details Computed as 2^(p log2(x)): within about 1e-5 of powf (relative)
+ * for exponents up to 32, the error growing with the exponent to about 2e-4
+ * at 1000. Results under 2^-126 are flushed to 0. Made only of arithmetic,
+ * bit operations and selects, so that loops over it run in vector
+ * registers, which powf (a library call) keeps from happening.
+ */
+inline float fastPow(float x, float p) {
+    float result = fastExp2(p * fastLog2(x));
+
+    /*
+     * log2(0) comes out as -127, so the result is masked to 0 for x <= 0.
+     * On its bits rather than with a select, which the compiler would turn
+     * into a branch around the floating point operations, keeping the loop
+     * out of vector registers.
+     */
+    unsigned int bits;
+    memcpy(&bits, &result, sizeof(bits));
+
+    bits &= -(unsigned int) (x > 0);
+    memcpy(&result, &bits, sizeof(result));
+
+    return result;
+}
+
+#endif //RAYTRA_FASTMATH_H
@@ -0,0 +1,47 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#ifndef RAYTRA_FLOAT4_H
+#define RAYTRA_FLOAT4_H
+
+
+/*
+ * Four floats in one vector register, as the compiler's vector extension:
+ * arithmetic on it runs across all four lanes at once, on any target.
+ * Vector, Point and RGB keep their three components in the first three
+ * lanes and 0 in the last one.
+ */
+typedef float Float4 __attribute__((vector_size(16)));
+
+/* The given value in every lane */
+inline Float4 splat(float c) {
+    Float4 lanes = {c, c, c, c};
+    return lanes;
+}
+
+/**
+ * @name sum3
+ * @brief the sum of the first three lanes, added from the first to the
+ * third as a scalar sum would.
+ */
+inline float sum3(Float4 lanes) {
+    return lanes[0] + lanes[1] + lanes[2];
+}
+
+/**
+ * @name rotate
+ * @brief moves every one of the first three lanes one lane down, the first
+ * going to the third: (a, b, c) becomes (b, c, a).
+ */
+inline Float4 rotate(Float4 lanes) {
+#if defined(__clang__)
+    return __builtin_shufflevector(lanes, lanes, 1, 2, 0, 3);
+#else
+    typedef int Int4 __attribute__((vector_size(16)));
+    Int4 order = {1, 2, 0, 3};
+    return __builtin_shuffle(lanes, order);
+#endif
+}
+
+#endif //RAYTRA_FLOAT4_H
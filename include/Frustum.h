@@ -0,0 +1,39 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#ifndef RAYTRA_FRUSTUM_H
+#define RAYTRA_FRUSTUM_H
+
+
+#include "Point.h"
+#include "Vector.h"
+#include "BoundingBox.h"
+
+/**
+ * A pyramid with four sides, enclosing a bundle of rays that pass through a
+ * common point (the apex) and a quadrilateral (the base): the shadow rays
+ * from a point to an area light, or the primary rays from the eye through a
+ * tile of the image. Used to cull bounding boxes that none of the rays can
+ * reach.
+ */
+class Frustum {
+private:
+    Point apex;
+
+    /* Side planes, the inside being where n.(p - apex) <= 0 */
+    Vector planes[4];
+    int num_planes;
+
+    /* Bounds of the frustum */
+    Point lo, hi;
+
+public:
+    Frustum();
+
+    Frustum(const Point &apex, const Point corners[4], bool capped);
+
+    bool misses(const BoundingBox &box) const;
+};
+
+#endif //RAYTRA_FRUSTUM_H
@@ -0,0 +1,77 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#ifndef RAYTRA_HIT_H
+#define RAYTRA_HIT_H
+
+#include <limits>
+#include "Point.h"
+#include "Vector.h"
+
+class Surface;
+
+/**
+ * A compact record of the closest intersection found along a ray.
+ *
+ * t, surface_idx, the barycentric co-ordinates (u, v) and the face normal
+ * are filled in by the intersection routines while searching for the closest
+ * surface. The point, normal and facing are resolved only once for the final
+ * hit so that shading never needs to go back to the surface to recompute
+ * them.
+ */
+class Hit {
+public:
+    /* Parameter of the intersection point along the ray */
+    float t;
+
+    /* Index of the intersected surface, -1 if nothing was hit */
+    int surface_idx;
+
+    /*
+     * The primitive that was actually hit. Same as the intersected surface
+     * unless the surface is made up of other surfaces (e.g. a Mesh).
+     */
+    const Surface *primitive;
+
+    /*
+     * Surface co-ordinates of the hit: barycentric weights of the 2nd and
+     * 3rd vertex for triangles, offsets along e1 and e2 for quads.
+     */
+    float u, v;
+
+    /*
+     * Face normal of the primitive, set by flat primitives when they are
+     * hit and deciding which side of them the ray came from. Left at 0 by
+     * primitives without a back side (spheres), which are always front
+     * faced.
+     */
+    Vector geometric_normal;
+
+    /*
+     * Whether the shading normal varies over the primitive (spheres, mesh
+     * triangles and quads) and has to be worked out by it; otherwise it is
+     * the face normal.
+     */
+    bool smooth;
+
+    Point point;
+
+    /* Shading normal, already flipped towards the viewer if back-faced */
+    Vector normal;
+
+    bool front_faced;
+
+    Hit() {
+        this->t = std::numeric_limits<float>::infinity();
+        this->surface_idx = -1;
+        this->primitive = nullptr;
+        this->u = 0;
+        this->v = 0;
+        this->smooth = true;
+        this->front_faced = true;
+    };
+};
+
+
+#endif //RAYTRA_HIT_H
@@ -0,0 +1,113 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#ifndef RAYTRA_KERNELS_H
+#define RAYTRA_KERNELS_H
+
+
+#include <string>
+#include "RayPacket.h"
+#include "Light.h"
+#include "Wavefront.h"
+
+/**
+ * The data-parallel loops of the renderer, compiled once for each
+ * instruction set they can run in, so that one binary uses the widest
+ * vector registers of whatever processor it runs on without requiring them
+ * of every processor.
+ *
+ * One set of kernels is picked at startup from the features the processor
+ * reports (CPUID), the widest it supports, and may be overridden by name.
+ * Every set does the same arithmetic in the same order, without fusing
+ * multiplies and adds, so the image does not depend on the one picked.
+ */
+class Kernels {
+public:
+    /* Name of the instruction set the kernels are compiled for */
+    const char *name;
+
+    /**
+     * @name    intersectBox
+     * @brief   Slab tests a bounding box against every ray of a packet.
+     *
+     * @param lanes  - the rays of the packet.
+     * @param box    - the bounding box.
+     * @param t_hits - receives the parameter at which each ray enters the
+     *                 box, if it does.
+     * @returns        the mask of the rays whose segment intersects the box.
+     */
+    unsigned int (*intersectBox)(const RayLanes &lanes,
+                                 const BoundingBox &box, float *t_hits);
+
+    /**
+     * @name    intersectBoxFrom
+     * @brief   As intersectBox, for rays that share their origin and the
+     *          signs of their directions.
+     *
+     * @param near | @param far - the distances from the shared origin to
+     *                the near and far slab planes, along x, y and z.
+     */
+    unsigned int (*intersectBoxFrom)(const RayLanes &lanes,
+                                     const float near[3], const float far[3],
+                                     float *t_hits);
+
+    /**
+     * @name    shadePointLights
+     * @brief   Works out the light a block of LIGHT_LANES point lights
+     *          brings to a shading point, as Material::phongShading would.
+     *
+     * @param lights   - the point lights.
+     * @param first    - index of the first light of the block.
+     * @param point | @param normal - the shading point and its normal.
+     * @param view     - unit vector from the point to the viewer.
+     * @param diffuse | @param specular | @param phong - the material.
+     * @param has_specular - whether the material has a highlight at all.
+     * @param fast_pow - use the approximate pow for the highlight.
+     * @param block    - receives the light of each light of the block.
+     */
+    void (*shadePointLights)(const PointLightArray &lights, size_t first,
+                             const Point &point, const Vector &normal,
+                             const Vector &view, const RGB &diffuse,
+                             const RGB &specular, float phong,
+                             bool has_specular, bool fast_pow,
+                             PointLightBlock &block);
+
+    /**
+     * @name    shadeLightSamples
+     * @brief   Runs the Phong model over the first count entries of a chunk
+     *          of light samples, leaving their light in its r, g, b arrays.
+     *
+     * @param fast_pow - use the approximate pow for the highlight.
+     */
+    void (*shadeLightSamples)(LightSamples &samples, int count,
+                              bool fast_pow);
+
+    /* The kernels in use, the best supported ones unless overridden */
+    static const Kernels *active;
+
+    Kernels(const char *name,
+            unsigned int (*intersectBox)(const RayLanes &,
+                                         const BoundingBox &, float *),
+            unsigned int (*intersectBoxFrom)(const RayLanes &,
+                                             const float *, const float *,
+                                             float *),
+            void (*shadePointLights)(const PointLightArray &, size_t,
+                                     const Point &, const Vector &,
+                                     const Vector &, const RGB &,
+                                     const RGB &, float, bool, bool,
+                                     PointLightBlock &),
+            void (*shadeLightSamples)(LightSamples &, int, bool)) {
+        this->name = name;
+        this->intersectBox = intersectBox;
+        this->intersectBoxFrom = intersectBoxFrom;
+        this->shadePointLights = shadePointLights;
+        this->shadeLightSamples = shadeLightSamples;
+    };
+
+    static const Kernels *get(const std::string &name);
+
+    static const Kernels *best();
+};
+
+#endif //RAYTRA_KERNELS_H
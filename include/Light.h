@@ -6,6 +6,7 @@
 #define RAYTRA_LIGHT_H
 
 
+#include <vector>
 #include "Point.h"
 #include "RGB.h"
 
@@ -31,6 +32,63 @@ public:
     ~PointLight() {};
 };
 
+/* Number of point lights shaded together, as lanes of vector registers */
+static const int LIGHT_LANES = 8;
+
+/**
+ * The point lights of a scene as a structure of arrays: their positions and
+ * colors, each in an array of its own, so that the shading model can be
+ * evaluated for LIGHT_LANES lights at once. The arrays are padded to a
+ * multiple of LIGHT_LANES with black lights at the origin, whose lanes are
+ * computed but never used.
+ */
+class PointLightArray {
+public:
+    std::vector<const PointLight *> lights;
+    std::vector<float> x, y, z;
+    std::vector<float> r, g, b;
+
+    PointLightArray(const std::vector<PointLight *> &plights) {
+        for (const PointLight *light : plights)
+            add(light, light->position, light->color);
+
+        while (x.size() % LIGHT_LANES != 0)
+            add(nullptr, Point(0, 0, 0), RGB(0, 0, 0));
+
+        this->lights.resize(plights.size());
+    };
+
+    void add(const PointLight *light, const Point &position,
+             const RGB &color) {
+        this->lights.push_back(light);
+        this->x.push_back(position.x);
+        this->y.push_back(position.y);
+        this->z.push_back(position.z);
+        this->r.push_back(color.r);
+        this->g.push_back(color.g);
+        this->b.push_back(color.b);
+    };
+
+    /* Number of lights, without the padding */
+    size_t size() const {
+        return lights.size();
+    };
+};
+
+/**
+ * The light one block of LIGHT_LANES lights of a PointLightArray brings to a
+ * shading point, as if none of them were blocked (see
+ * Kernels::shadePointLights).
+ */
+class PointLightBlock {
+public:
+    /* Unit vectors from the shading point to the lights */
+    float ix[LIGHT_LANES], iy[LIGHT_LANES], iz[LIGHT_LANES];
+
+    /* Light brought by each of them */
+    float r[LIGHT_LANES], g[LIGHT_LANES], b[LIGHT_LANES];
+};
+
 class SquareLight : public Light {
 public:
     Point center;
@@ -54,28 +112,31 @@ public:
 
     /**
      * @name getLightSample
-     * @brief returns a random point (within a given strata) on the area light
+     * @brief returns the point on the area light at the given position
      *
-     * @details The area light is broken down into blocks (or stratas) from
-     * which a random point is chosen for sampling. For example given a value
-     * of 2 for @param strata the total number of blocks in the area light would
-     * be equal to the sqaure of @param strata.
+     * @details The position is given in co-ordinates along the u and v
+     * edges of the light, both in [0, 1], as obtained from a Sampler which
+     * spreads (stratifies) the samples over the light.
      *
-     * @param p - column index for the block of the stratified area light.
-     * @param q - row index of the block of the stratified area light.
-     * @param strata - total number of divisions along one axis. Total number
-     * of blocks equal to the square of this value
+     * @param u_d - position along the u edge of the area light.
+     * @param v_d - position along the v edge of the area light.
      */
-    Point getLightSample(int p, int q, int strata) {
-        Point sample;
-
-        float u_d = (p + ((float) rand() / RAND_MAX)) / strata;
-        float v_d = (q + ((float) rand() / RAND_MAX)) / strata;
-
+    Point getLightSample(float u_d, float v_d) const {
         return center
                 .moveAlong(u.times((u_d - 0.5f) * len))
                 .moveAlong(v.times((v_d - 0.5f) * len));
     }
+
+    /**
+     * @name getCorners
+     * @brief gives the four corners of the area light, in order around it.
+     */
+    void getCorners(Point corners[4]) const {
+        corners[0] = getLightSample(0, 0);
+        corners[1] = getLightSample(1, 0);
+        corners[2] = getLightSample(1, 1);
+        corners[3] = getLightSample(0, 1);
+    }
 };
 
 
@@ -0,0 +1,101 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#ifndef RAYTRA_LIGHTTREE_H
+#define RAYTRA_LIGHTTREE_H
+
+
+#include <vector>
+#include "Light.h"
+
+/**
+ * A light in the LightTree: either a point light or a square light along
+ * with the bounds of its position and its total power.
+ */
+class LightEntry {
+public:
+    const PointLight *plight;
+    const SquareLight *slight;
+
+    Point lo, hi;
+    float power;
+
+    /*
+     * Beyond this distance from its bounds the light can contribute no more
+     * than the cutoff set on the LightTree. Infinite without a cutoff.
+     */
+    float radius;
+
+    LightEntry(const PointLight *light);
+
+    LightEntry(const SquareLight *light);
+};
+
+class LightTreeNode {
+public:
+    /* Bounds of the positions of all lights under this node */
+    Point lo, hi;
+
+    /* Total power of all lights under this node */
+    float power;
+
+    /* Bounds of the region influenced by any light under this node */
+    Point influence_lo, influence_hi;
+
+    /* Index of the light in the tree, -1 for inner nodes */
+    int light_idx;
+
+    LightTreeNode *left;
+    LightTreeNode *right;
+
+    LightTreeNode() {
+        this->power = 0;
+        this->light_idx = -1;
+        this->left = nullptr;
+        this->right = nullptr;
+    };
+
+    ~LightTreeNode() {
+        delete this->left;
+        delete this->right;
+    };
+};
+
+/**
+ * A bounding volume hierarchy over the lights of the scene, used to pick a
+ * few lights per shading point with probability proportional to an estimate
+ * of their contribution at that point.
+ */
+class LightTree {
+private:
+    LightTreeNode *root;
+    std::vector<LightEntry> lights;
+
+    LightTreeNode *_makeLightTree(int start, int end);
+
+    float importance(const LightTreeNode *node, const Point &p) const;
+
+    void _setInfluence(LightTreeNode *node);
+
+public:
+    LightTree(const std::vector<PointLight *> &plights,
+              const std::vector<SquareLight *> &slights);
+
+    ~LightTree();
+
+    int size() const;
+
+    const LightEntry &at(int index) const;
+
+    int sample(const Point &p, float &pdf) const;
+
+    void setCutoff(float cutoff, float max_reflectance);
+
+    bool influences(int index, const Point &p) const;
+
+    void getInfluencingLights(const Point &p, std::vector<int> &out) const;
+};
+
+
+#endif //RAYTRA_LIGHTTREE_H
@@ -7,19 +7,48 @@
 
 
 #include "RGB.h"
+#include "Ray.h"
+#include "Hit.h"
 
+/**
+ * Materials of a scene are kept together in a single table (a vector) and
+ * surfaces refer to them by their index in it. Flags that shading checks on
+ * every hit are worked out once when the material is made.
+ */
 class Material {
+private:
+    void computeFlags() {
+        this->reflective = ideal_specular.r > 0 ||
+                           ideal_specular.g > 0 ||
+                           ideal_specular.b > 0;
+        this->specular_free = specular.r <= 0 &&
+                              specular.g <= 0 &&
+                              specular.b <= 0;
+        this->black = specular_free &&
+                      diffuse.r <= 0 && diffuse.g <= 0 && diffuse.b <= 0;
+    };
+
 public:
     RGB diffuse;
     RGB specular;
     RGB ideal_specular;
     float phong;
 
+    /* Reflects rays, i.e. has a non-zero ideal specular component */
+    bool reflective;
+
+    /* Has no phong highlight, i.e. a zero specular component */
+    bool specular_free;
+
+    /* Front faces reflect no light from light sources at all */
+    bool black;
+
     Material() {
         this->diffuse = RGB(0, 0, 0);
         this->specular = RGB(0, 0, 0);
         this->ideal_specular = RGB(0, 0, 0);
         this->phong = 1;
+        computeFlags();
     };
 
     Material(float dr, float dg, float db,
@@ -29,7 +58,13 @@ public:
         this->specular = RGB(sr, sg, sb);
         this->ideal_specular = RGB(ir, ig, ib);
         this->phong = r;
+        computeFlags();
     };
+
+    RGB phongShading(const RGB &light_color,
+                     const Ray &light_ray,
+                     const Ray &view_ray,
+                     const Hit &hit) const;
 };
 
 
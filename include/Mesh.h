@@ -0,0 +1,69 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#ifndef RAYTRA_MESH_H
+#define RAYTRA_MESH_H
+
+
+#include <vector>
+#include "Surface.h"
+#include "BVHTree.h"
+
+static const int MAX_LOD_LEVELS = 6;
+static const int MIN_LOD_TRIANGLES = 64;
+
+/**
+ * A mesh loaded from a wavefront file along with progressively simplified
+ * versions of it (levels of detail). Every level has a BVHTree of its own and
+ * each ray picks the coarsest level whose edges are still small compared to
+ * the footprint of the ray at the mesh.
+ */
+class Mesh : public Surface {
+private:
+    std::vector<std::vector<Surface *> *> levels;
+    std::vector<BVHTree *> trees;
+
+    /* Mean edge length of each level */
+    std::vector<float> edge_lengths;
+
+    float lod_threshold;
+
+    int selectLevel(const Ray &ray) const;
+
+public:
+    Mesh(float lod_threshold);
+
+    ~Mesh();
+
+    void addLevel(const std::vector<Surface *> &surfaces, float edge_length);
+
+    void build();
+
+    int levelCount() const;
+
+    int levelSize(int level) const;
+
+    float getIntersection(const Ray &) const;
+
+    float getIntersection(const Ray &, Hit &) const;
+
+    Vector getSurfaceNormal(const Point &) const;
+
+    Vector getSurfaceNormal(const Hit &) const;
+
+    bool isFrontFacedTo(const Ray &) const;
+
+    bool intercepts(const Ray &ray, float t_max) const;
+
+    static float meanEdgeLength(const std::vector<int> &tris,
+                                const std::vector<float> &verts);
+
+    static void decimate(const std::vector<int> &tris,
+                         const std::vector<float> &verts, float cell,
+                         std::vector<int> &out_tris,
+                         std::vector<float> &out_verts);
+};
+
+
+#endif //RAYTRA_MESH_H
@@ -6,6 +6,7 @@
 #include "Camera.h"
 #include "Light.h"
 #include "Surface.h"
+#include "RenderOptions.h"
 #include <iostream>
 
 using namespace std;
@@ -21,11 +22,23 @@ void read_wavefront_file(const char *,
                          vector<int> &,
                          vector<float> &);
 
+void merge_triangle_pairs(const vector<int> &tris,
+                          const vector<float> &verts,
+                          vector<int> &quads,
+                          vector<bool> &merged);
+
+void build_mesh(const vector<int> &tris,
+                const vector<float> &verts,
+                uint32_t material,
+                bool closed,
+                vector<Surface *> &surfaces);
+
 void parseSceneFile(char *filename,
                     vector<Surface *> &surfaces,
-                    vector<Material *> &materials,
+                    vector<Material> &materials,
                     vector<PointLight *> &plights,
                     vector<SquareLight *> &slights,
                     AmbientLight &ambient,
-                    Camera *cam);
+                    Camera *cam,
+                    const RenderOptions &options);
 
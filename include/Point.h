@@ -7,32 +7,47 @@
 
 #include "Vector.h"
 
+/**
+ * A point in 3D, kept in the lanes of a Float4 as Vector is.
+ */
 class Point {
 public:
-    float x, y, z;
+    union {
+        Float4 lanes;
+        struct {
+            float x, y, z;
+        };
+    };
 
     Point() {
-        this->x = 0.0;
-        this->y = 0.0;
-        this->z = 0.0;
+        this->lanes = splat(0);
     };
 
     Point(float x, float y, float z) {
-        this->x = x;
-        this->y = y;
-        this->z = z;
+        Float4 lanes = {x, y, z, 0};
+        this->lanes = lanes;
+    };
+
+    explicit Point(Float4 lanes) {
+        this->lanes = lanes;
     };
 
     inline Vector sub(const Point &p) const {
-        return Vector(x - p.x, y - p.y, z - p.z);
+        return Vector(lanes - p.lanes);
     };
 
     inline Point moveAlong(const Vector &vec) const {
-        return Point(x + vec.i, y + vec.j, z + vec.k);
+        return Point(lanes + vec.lanes);
+    };
+
+    /* Moves along vec * c, without the vector in between */
+    inline Point moveAlong(const Vector &vec, float c) const {
+        return Point(lanes + vec.lanes * splat(c));
     };
 
     inline float distance2(const Point &p) const {
-        return powf(x - p.x, 2.0) + powf(y - p.y, 2.0) + powf(z - p.z, 2.0);
+        Float4 d = lanes - p.lanes;
+        return sum3(d * d);
     };
 
     inline void printPoint() const {
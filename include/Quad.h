@@ -0,0 +1,47 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#ifndef RAYTRA_QUAD_H
+#define RAYTRA_QUAD_H
+
+
+#include "Surface.h"
+
+/**
+ * A planar quad in the shape of a parallelogram. The corners are p1,
+ * p1 + e1, p1 + e1 + e2 and p1 + e2 in counter-clockwise order with respect
+ * to the surface normal.
+ */
+class Quad : public Surface {
+private:
+    /* Dual basis of (e1, e2) in the plane of the quad */
+    Vector _a1, _a2;
+
+public:
+    bool isInMesh;
+
+    /* Only intersect rays approaching the front side (closed meshes) */
+    bool cullBackFaces;
+    Point p1;
+    Vector e1, e2;
+    Vector normal;
+    Vector n1, n2, n3, n4;
+
+    Quad(float, float, float, float, float, float, float, float, float);
+
+    ~Quad() {};
+
+    float getIntersection(const Ray &) const;
+
+    float getIntersection(const Ray &, Hit &) const;
+
+    Vector getSurfaceNormal(const Point &) const;
+
+    Vector getSurfaceNormal(const Hit &) const;
+
+    bool isFrontFacedTo(const Ray &) const;
+};
+
+
+#endif //RAYTRA_QUAD_H
@@ -5,35 +5,53 @@
 #ifndef RAYTRA_RGB_H
 #define RAYTRA_RGB_H
 
+#include <iostream>
+#include "Float4.h"
 
+/**
+ * A color, kept in the lanes of a Float4 as Vector is.
+ */
 class RGB {
 public:
-    float r, g, b;
+    union {
+        Float4 lanes;
+        struct {
+            float r, g, b;
+        };
+    };
 
     RGB() {
-        this->r = 0.0;
-        this->g = 0.0;
-        this->b = 0.0;
+        this->lanes = splat(0);
     }
 
     RGB(float r, float g, float b) {
-        this->r = r;
-        this->g = g;
-        this->b = b;
+        Float4 lanes = {r, g, b, 0};
+        this->lanes = lanes;
+    }
+
+    explicit RGB(Float4 lanes) {
+        this->lanes = lanes;
     }
 
     inline void add(const RGB shade) {
-        r += shade.r;
-        g += shade.g;
-        b += shade.b;
+        lanes += shade.lanes;
+    };
+
+    /* Adds shade * c, without the color in between */
+    inline void addTimes(const RGB &shade, float c) {
+        lanes += shade.lanes * splat(c);
     };
 
     inline RGB scaleRGB(const RGB shade) const {
-        return RGB(r * shade.r, g * shade.g, b * shade.b);
+        return RGB(lanes * shade.lanes);
     };
 
     inline RGB times(float c) const {
-        return RGB(r * c, g * c, b * c);
+        return RGB(lanes * splat(c));
+    };
+
+    inline float maxComponent() const {
+        return r > g ? (r > b ? r : b) : (g > b ? g : b);
     };
 
     inline void printRGB() const {
@@ -15,10 +15,31 @@ public:
     Point origin;
     Vector direction;
 
+    /*
+     * Precomputed for slab tests against bounding boxes: the reciprocal of
+     * each direction component and whether that component is negative.
+     */
+    Vector inv_direction;
+    int sign[3];
+
+    /* Only the segment [t_min, t_max] of the ray is of interest */
+    float t_min;
+    float t_max;
+
+    /*
+     * The ray is traced as a thin cone: its width at the origin and the rate
+     * at which the width grows along the ray.
+     */
+    float cone_width;
+    float cone_spread;
+
+    Ray();
+
     Ray(const Point &, const Vector &);
 
     Point getPointOnIt(float) const;
     float getOffsetFromOrigin(const Point &) const;
+    float getFootprint(float) const;
 };
 
 
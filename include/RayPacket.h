@@ -0,0 +1,85 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#ifndef RAYTRA_RAYPACKET_H
+#define RAYTRA_RAYPACKET_H
+
+
+#include "Ray.h"
+#include "BoundingBox.h"
+#include "Frustum.h"
+
+/* Largest number of rays traced together as one packet */
+static const int RAY_PACKET_SIZE = 16;
+
+/**
+ * The rays of a packet as a structure of arrays, over which the bounding
+ * box tests run (see Kernels::intersectBox).
+ */
+class RayLanes {
+public:
+    float ox[RAY_PACKET_SIZE], oy[RAY_PACKET_SIZE], oz[RAY_PACKET_SIZE];
+    float ix[RAY_PACKET_SIZE], iy[RAY_PACKET_SIZE], iz[RAY_PACKET_SIZE];
+    int sx[RAY_PACKET_SIZE], sy[RAY_PACKET_SIZE], sz[RAY_PACKET_SIZE];
+    float t_min[RAY_PACKET_SIZE], t_max[RAY_PACKET_SIZE];
+};
+
+/**
+ * A bundle of coherent rays, such as the shadow rays from one shading point
+ * to one area light, traced through the BVHTree together.
+ *
+ * The rays are kept both as they are, for the leaf intersections which are
+ * done per ray, and as a structure of arrays over which the bounding box
+ * tests run across all rays of the packet at once. The packet is also
+ * enclosed in a frustum (with a bounding box) so that whole subtrees that
+ * lie outside of it are culled with a single test.
+ *
+ * Rays that all start at one point with the same direction signs, such as
+ * the primary rays of a block of pixels, are culled instead with interval
+ * arithmetic over the range of their directions, and their box tests share
+ * the distances from the common origin to the slab planes.
+ */
+class RayPacket {
+private:
+    /* Structure of arrays over the rays of the packet */
+    RayLanes lanes;
+
+    /* Encloses all rays of the packet; unbounded unless set */
+    Frustum frustum;
+
+    /* The origin of all rays, if they share one */
+    Point origin;
+    bool shared_origin;
+
+    /*
+     * Whether all rays have the same direction signs, and the range of their
+     * reciprocal directions along each axis.
+     */
+    bool coherent;
+    Vector inv_lo, inv_hi;
+
+public:
+    Ray rays[RAY_PACKET_SIZE];
+    int size;
+
+    RayPacket();
+
+    void add(const Ray &ray);
+
+    void setFrustum(const Point &apex, const Point corners[4]);
+
+    unsigned int activeMask() const;
+
+    bool frustumMisses(const BoundingBox &box) const;
+
+    bool intervalMisses(const BoundingBox &box, float t_far) const;
+
+    unsigned int intersectBox(const BoundingBox &box,
+                              unsigned int active) const;
+
+    unsigned int intersectBox(const BoundingBox &box, unsigned int active,
+                              float *t_hits) const;
+};
+
+#endif //RAYTRA_RAYPACKET_H
@@ -0,0 +1,150 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#ifndef RAYTRA_RENDEROPTIONS_H
+#define RAYTRA_RENDEROPTIONS_H
+
+#include "Sampler.h"
+
+/* Default number of surfaces a ray may bounce off */
+static const int RECURSIVE_LIMIT = 20;
+
+/*
+ * Default throughput under which reflections are dropped; about one ulp of a
+ * half precision channel of the output near 1.
+ */
+static const float THROUGHPUT_EPSILON = 1.0f / 2048;
+
+/**
+ * Knobs controlling how the scene is rendered, as set on the command line.
+ */
+class RenderOptions {
+public:
+    /* @see README.md - Run Modes */
+    int mode;
+
+    /* Number of samples taken per pixel / area light */
+    int p_samples;
+    int s_samples;
+
+    /*
+     * Total number of samples per area light for a whole pixel, spread over
+     * its primary samples instead of taking s_samples for each of them.
+     * 0 disables the budget.
+     */
+    int shadow_budget;
+
+    /* Places the samples within a pixel / on an area light */
+    const Sampler *sampler;
+
+    /*
+     * Meshes switch to a coarser level of detail once its edges are
+     * shorter than this many ray footprints. 0 disables level of detail.
+     */
+    float lod_threshold;
+
+    /*
+     * Number of lights picked from the LightTree per shading point. 0 shades
+     * from every light.
+     */
+    int light_samples;
+
+    /*
+     * Probe area lights with a few shadow rays first and only cast all
+     * s_samples of them when the probes disagree (in the penumbra).
+     */
+    bool adaptive_shadows;
+
+    /*
+     * Lights are skipped at points where they can contribute no more than
+     * this. 0 shades from every light everywhere.
+     */
+    float light_cutoff;
+
+    /*
+     * Adaptive anti-aliasing: every pixel takes between aa_min_samples and
+     * aa_max_samples primary samples, stopping once the standard error of
+     * its brightness is under aa_tolerance. aa_max_samples of 0 disables it
+     * and p_samples samples are taken instead.
+     */
+    int aa_min_samples;
+    int aa_max_samples;
+    float aa_tolerance;
+
+    /* Maximum number of surfaces along a chain of reflections */
+    int max_depth;
+
+    /* Reflections whose throughput falls under this are dropped */
+    float throughput_epsilon;
+
+    /*
+     * Reflections whose throughput falls under this play Russian roulette:
+     * they survive with a probability proportional to their throughput.
+     * 0 disables Russian roulette.
+     */
+    float roulette;
+
+    /*
+     * Render with the wavefront renderer, which takes rays in batches through
+     * separate stages instead of following one ray at a time.
+     */
+    bool wavefront;
+
+    /*
+     * The wavefront renderer sorts reflected rays by direction and origin
+     * before tracing them, so that similar rays are traced together.
+     */
+    bool sort_rays;
+
+    /*
+     * The wavefront renderer traces the primary rays of blocks of pixels
+     * together as packets.
+     */
+    bool packets;
+
+    /*
+     * The wavefront renderer rasterizes the scene into a visibility buffer
+     * and takes the primary hits from it instead of tracing primary rays.
+     */
+    bool raster;
+
+    /*
+     * The wavefront renderer writes the hits to a G-buffer and shades them
+     * in a separate pass over all shadow rays of a tile.
+     */
+    bool deferred;
+
+    /*
+     * Highlights are shaded with a fast approximation of pow which runs in
+     * vector instructions, instead of powf.
+     */
+    bool fast_pow;
+
+    RenderOptions() {
+        this->mode = -1;
+        this->p_samples = 1;
+        this->s_samples = 1;
+        this->shadow_budget = 0;
+        this->sampler = Sampler::get("jittered");
+        this->lod_threshold = 0;
+        this->light_samples = 0;
+        this->adaptive_shadows = false;
+        this->light_cutoff = 0;
+        this->aa_min_samples = 0;
+        this->aa_max_samples = 0;
+        this->aa_tolerance = 0;
+        this->max_depth = RECURSIVE_LIMIT;
+        this->throughput_epsilon = THROUGHPUT_EPSILON;
+        this->roulette = 0;
+        this->wavefront = false;
+        this->sort_rays = false;
+        this->packets = false;
+        this->raster = false;
+        this->deferred = false;
+        this->fast_pow = false;
+    };
+};
+
+
+#endif //RAYTRA_RENDEROPTIONS_H
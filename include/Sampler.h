@@ -0,0 +1,123 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#ifndef RAYTRA_SAMPLER_H
+#define RAYTRA_SAMPLER_H
+
+
+#include <string>
+
+/**
+ * Generates sets of sample points in the unit square, used to place primary
+ * rays within a pixel and shadow rays on an area light.
+ *
+ * A set holds any number of points (not just perfect squares) and is asked
+ * for one point at a time by its index. The seed decorrelates sets from one
+ * another, e.g. those of neighbouring pixels, so that their patterns don't
+ * line up into visible structure. Samplers hold no state and may be shared.
+ */
+class Sampler {
+public:
+    virtual ~Sampler() {}
+
+    /**
+     * @name    get2D
+     * @brief   Gets the k-th point of a set of count points.
+     *
+     * @param k     - index of the point in the set, in [0, count).
+     * @param count - number of points in the set.
+     * @param seed  - scrambles the set.
+     * @param u | @param v - receive the co-ordinates of the point, in [0, 1].
+     */
+    virtual void get2D(int k, int count, unsigned int seed,
+                       float &u, float &v) const = 0;
+
+    static const Sampler *get(const std::string &name);
+};
+
+/**
+ * Stratified jittered sampling: the square is split into rows x cols blocks
+ * (as close to square as count allows) with a random point in each block.
+ * Draws from rand() and ignores the seed.
+ */
+class JitteredSampler : public Sampler {
+public:
+    void get2D(int k, int count, unsigned int seed,
+               float &u, float &v) const;
+};
+
+/**
+ * The Halton sequence in bases 2 and 3, shifted by a random offset
+ * (Cranley-Patterson rotation) derived from the seed.
+ */
+class HaltonSampler : public Sampler {
+public:
+    void get2D(int k, int count, unsigned int seed,
+               float &u, float &v) const;
+};
+
+/**
+ * The (0, 2) Sobol sequence with random digit scrambling derived from the
+ * seed. Any prefix of a power of two points is stratified over the square.
+ */
+class SobolSampler : public Sampler {
+public:
+    void get2D(int k, int count, unsigned int seed,
+               float &u, float &v) const;
+};
+
+/**
+ * Correlated multi-jittered sampling (Kensler): jittered samples that are
+ * also stratified along each axis, for any count.
+ */
+class CMJSampler : public Sampler {
+public:
+    void get2D(int k, int count, unsigned int seed,
+               float &u, float &v) const;
+};
+
+/**
+ * A run of consecutive points out of a larger sample set, so that several
+ * shading points (e.g. all primary samples of a pixel) can share one set of
+ * shadow samples between them instead of each drawing a full set.
+ */
+class SampleWindow {
+public:
+    /* Seed of the shared set */
+    unsigned int seed;
+
+    /* The window covers points [first, first + count) of the set */
+    int first, count;
+
+    /* Size of the shared set, 0 if there is no shared set */
+    int total;
+
+    SampleWindow() {
+        this->seed = 0;
+        this->first = 0;
+        this->count = 0;
+        this->total = 0;
+    };
+
+    /**
+     * The k-th of n windows splitting a set of total points as evenly as
+     * possible. Every window gets at least one point, so with fewer points
+     * than windows some points are shared.
+     */
+    SampleWindow(unsigned int seed, int k, int n, int total) {
+        this->seed = seed;
+        this->first = (int) ((long) k * total / n);
+        this->count = (int) ((long) (k + 1) * total / n) - first;
+        this->total = total;
+
+        if (this->count < 1)
+            this->count = 1;
+    };
+};
+
+/* Hashes a few integers (e.g. pixel co-ordinates) into a sampler seed */
+unsigned int hashSeed(unsigned int a, unsigned int b = 0);
+
+
+#endif //RAYTRA_SAMPLER_H
@@ -20,8 +20,12 @@ public:
 
     float getIntersection(const Ray &) const;
 
+    float getIntersection(const Ray &, Hit &) const;
+
     Vector getSurfaceNormal(const Point &) const;
 
+    Vector getSurfaceNormal(const Hit &) const;
+
     bool isFrontFacedTo(const Ray &) const;
 };
 
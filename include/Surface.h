@@ -6,45 +6,58 @@
 #define RAYTRA_SURFACE_H
 
 #include <iostream>
+#include <cstdint>
 #include "Point.h"
 #include "Ray.h"
 #include "Material.h"
 #include "Light.h"
 #include "BoundingBox.h"
+#include "Hit.h"
 #include <math.h>
 
 class Surface {
-private:
-    Material *material;
-
 public:
     BoundingBox *bbox;
 
+    /* Index of the material of the surface in the scene's material table */
+    uint32_t material_idx;
+
+    Surface() {
+        this->material_idx = 0;
+    }
+
     virtual ~Surface() {}
 
     virtual float getIntersection(const Ray &) const = 0;
 
-    virtual Vector getSurfaceNormal(const Point &) const = 0;
-
-    virtual bool isFrontFacedTo(const Ray &) const = 0;
+    /*
+     * Also records the surface co-ordinates of the intersection in the hit.
+     * The hit comes in holding the closest intersection found so far (its
+     * t), so that surfaces searching within themselves can stop at it.
+     */
+    virtual float getIntersection(const Ray &, Hit &) const = 0;
 
-    void setMaterial(Material *m) {
-        this->material = m;
-    }
+    virtual Vector getSurfaceNormal(const Point &) const = 0;
 
-    bool isReflective() const;
+    virtual Vector getSurfaceNormal(const Hit &) const = 0;
 
-    RGB getDiffuseComponent() const;
+    virtual bool isFrontFacedTo(const Ray &) const = 0;
 
-    RGB getReflectiveComponent() const;
+    /**
+     * @name    intercepts
+     * @brief   Determines if the surface intercepts the ray before it gets
+     *          (within 0.05) to t_max. Any intersection will do, so surfaces
+     *          made up of others stop at the first one found.
+     */
+    virtual bool intercepts(const Ray &ray, float t_max) const {
+        float t = this->getIntersection(ray);
 
-    RGB getSpecularComponent() const;
+        return (t >= 0 && t < t_max - 0.05f);
+    }
 
-    RGB phongShading(const RGB &light_color,
-                     const Ray &light_ray,
-                     const Ray &view_ray,
-                     const Point &intersection,
-                     int mode) const;
+    void setMaterial(uint32_t material_idx) {
+        this->material_idx = material_idx;
+    }
 };
 
 
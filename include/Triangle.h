@@ -11,6 +11,9 @@
 class Triangle : public Surface {
 public:
     bool isInMesh;
+
+    /* Only intersect rays approaching the front side (closed meshes) */
+    bool cullBackFaces;
     Point p1;
     Point p2;
     Point p3;
@@ -24,8 +27,12 @@ public:
 
     float getIntersection(const Ray &) const;
 
+    float getIntersection(const Ray &, Hit &) const;
+
     Vector getSurfaceNormal(const Point &) const;
 
+    Vector getSurfaceNormal(const Hit &) const;
+
     bool isFrontFacedTo(const Ray &) const;
 };
 
@@ -8,58 +8,78 @@
 #include <assert.h>
 #include <iostream>
 #include <math.h>
-
+#include "Float4.h"
+
+/**
+ * A vector in 3D, kept in the lanes of a Float4 (with 0 in the last one) so
+ * that its arithmetic runs on all components at once. The arithmetic of
+ * every component is the same as it would be on its own, so the results
+ * are the same to the bit.
+ */
 class Vector {
 public:
-    float i, j, k;
+    union {
+        Float4 lanes;
+        struct {
+            float i, j, k;
+        };
+    };
 
     Vector() {
-        this->i = this->j = this->k = 0;
+        this->lanes = splat(0);
     };
 
     Vector(float i, float j, float k) {
-        this->i = i;
-        this->j = j;
-        this->k = k;
+        Float4 lanes = {i, j, k, 0};
+        this->lanes = lanes;
+    };
+
+    explicit Vector(Float4 lanes) {
+        this->lanes = lanes;
     };
 
     inline float mag() const {
-        return sqrtf(powf(i, 2.0) + powf(j, 2.0) + powf(k, 2.0));
+        return sqrtf(dot(*this));
     };
 
+    /* One square root and one division of all lanes by it */
     inline Vector norm() const {
         float mag = this->mag();
         assert (mag != 0.0);
 
-        return Vector(i / mag, j / mag, k / mag);
+        return Vector(lanes / splat(mag));
     };
 
     inline Vector times(float c) const {
-        return Vector(i * c, j * c, k * c);
+        return Vector(lanes * splat(c));
     };
 
     inline Vector cross(const Vector &vec) const {
-        return Vector(j * vec.k - k * vec.j,
-                      k * vec.i - i * vec.k,
-                      i * vec.j - j * vec.i);
+        Float4 a = rotate(lanes), b = rotate(vec.lanes);
+
+        /* (j * vec.k - k * vec.j, k * vec.i - i * vec.k, ...) */
+        return Vector(rotate(lanes * b - a * vec.lanes));
     };
 
     inline float dot(const Vector &vec) const {
-        return i * vec.i + j * vec.j + k * vec.k;
+        return sum3(lanes * vec.lanes);
     };
 
     inline Vector plus(const Vector &vec) const {
-        return Vector(i + vec.i, j + vec.j, k + vec.k);
+        return Vector(lanes + vec.lanes);
+    };
+
+    /* this + vec * c, without the vector in between */
+    inline Vector plusTimes(const Vector &vec, float c) const {
+        return Vector(lanes + vec.lanes * splat(c));
     };
 
     inline void plusEq(const Vector &vec) {
-        i += vec.i;
-        j += vec.j;
-        k += vec.k;
+        lanes += vec.lanes;
     };
 
     inline Vector operator-() const {
-        return Vector(-i, -j, -k);
+        return Vector(-lanes);
     };
 
     inline bool equals(const Vector vec) const {
@@ -0,0 +1,121 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#ifndef RAYTRA_VISIBILITYBUFFER_H
+#define RAYTRA_VISIBILITYBUFFER_H
+
+
+#include <vector>
+#include "Point.h"
+#include "Vector.h"
+#include "Surface.h"
+#include "BVHTree.h"
+#include "RenderOptions.h"
+
+class Camera;
+
+/* Edge of the square tiles of pixels the rasterizer threads take at once */
+static const int RASTER_TILE_SIZE = 16;
+
+/**
+ * A triangle (a whole one, or one half of a quad) or a sphere set up for
+ * rasterization, in the frame of the camera: x along u, y along v and z
+ * along w, with the eye at the origin and the image plane at z = -d.
+ */
+class RasterPrimitive {
+public:
+    /* Index of the surface in the scene, and the surface itself */
+    int surface_idx;
+    const Surface *primitive;
+
+    bool sphere;
+
+    /*
+     * Triangles: normals of the planes through the eye and each edge, of
+     * unit length and facing inwards, and the plane of the triangle as
+     * n.p = offset.
+     */
+    Vector edges[3];
+    Vector normal;
+    float offset;
+
+    /* Spheres: the center and the squared radius */
+    Point center;
+    float radius2;
+
+    /* Pixels the primitive may cover: columns [x0, x1), rows [y0, y1) */
+    int x0, y0, x1, y1;
+};
+
+/**
+ * The closest surface seen through every primary sample of the image,
+ * found by rasterizing the scene instead of tracing a ray per sample.
+ *
+ * Every triangle, quad and sphere is projected onto the image plane and
+ * tested against the samples of the pixels it covers, keeping the nearest
+ * along each sample's ray: the index of the primitive and its depth. The
+ * image is split into tiles which several threads rasterize at once, each
+ * tile testing only the primitives binned to it.
+ *
+ * The rasterizer errs towards covering too much: a sample it places on the
+ * edge of a primitive which the ray then just misses is traced instead.
+ * Surfaces that can't be projected as a whole (meshes with levels of detail,
+ * whose triangles depend on the ray) are left to be intersected directly.
+ */
+class VisibilityBuffer {
+private:
+    int pw, ph, p_samples;
+
+    /* Position of each sample within its pixel, both in [0, 1] */
+    std::vector<float> x_offsets, y_offsets;
+
+    /* Nearest primitive of each sample (-1 for none) and its depth */
+    std::vector<int> ids;
+    std::vector<float> depths;
+
+    std::vector<RasterPrimitive> primitives;
+
+    /* Surfaces which are not rasterized */
+    std::vector<int> unrasterized;
+
+    int threads;
+
+    void setUp(const Camera &camera, const BVHTree &surfaces);
+
+    void addTriangle(const Camera &camera, int surface_idx,
+                     const Surface *primitive, const Point &p1,
+                     const Point &p2, const Point &p3);
+
+    void addSphere(const Camera &camera, int surface_idx,
+                   const Surface *primitive, const Point &center,
+                   float radius);
+
+    void setBounds(const Camera &camera, RasterPrimitive &raster,
+                   const Point *corners, int count);
+
+    void rasterizeTile(const Camera &camera, int tile_x, int tile_y,
+                       const std::vector<int> &bin);
+
+    size_t sampleIndex(int i, int j, int k) const;
+
+public:
+    VisibilityBuffer();
+
+    void build(const Camera &camera, const BVHTree &surfaces,
+               const RenderOptions &options);
+
+    void getOffsets(int i, int j, int k, float &x_d, float &y_d) const;
+
+    const RasterPrimitive *lookup(int i, int j, int k) const;
+
+    const std::vector<int> &unrasterizedSurfaces() const;
+
+    size_t primitiveCount() const;
+
+    size_t sampleCount() const;
+
+    int threadCount() const;
+};
+
+#endif //RAYTRA_VISIBILITYBUFFER_H
@@ -0,0 +1,302 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#ifndef RAYTRA_WAVEFRONT_H
+#define RAYTRA_WAVEFRONT_H
+
+
+#include <vector>
+#include <utility>
+#include <ctime>
+#include "Ray.h"
+#include "Hit.h"
+#include "RGB.h"
+#include "Light.h"
+#include "Sampler.h"
+#include "Material.h"
+
+/* Number of primary samples that go through the stages together, at most */
+static const int WAVEFRONT_BATCH_SIZE = 1024;
+
+/* Largest edge of a tile of pixels going through the stages together */
+static const int WAVEFRONT_MAX_TILE_SIZE = 64;
+
+/*
+ * Edge of the blocks of pixels whose primary rays make up a packet; a block
+ * has RAY_PACKET_SIZE pixels.
+ */
+static const int PACKET_BLOCK_SIZE = 4;
+
+/**
+ * A path in flight through the wavefront renderer: a primary sample and,
+ * once it bounces, the reflected ray it continues along.
+ */
+class PathState {
+public:
+    /* Index of the primary sample (within the tile) the path belongs to */
+    int sample;
+
+    Ray ray;
+    RGB throughput;
+    SampleWindow window;
+
+    /* The closest hit along the ray */
+    Hit hit;
+
+    /*
+     * Light gathered at the hit, in the same two sums (point lights, then
+     * square lights) as Camera::getShadeAlongRay so that the result is the
+     * same to the bit.
+     */
+    RGB direct[2];
+
+    PathState(int sample, const Ray &ray, const RGB &throughput,
+              const SampleWindow &window) {
+        this->sample = sample;
+        this->ray = ray;
+        this->throughput = throughput;
+        this->window = window;
+        this->direct[0] = RGB(0, 0, 0);
+        this->direct[1] = RGB(0, 0, 0);
+    };
+};
+
+/**
+ * A shadow ray from a light towards the hit of a path. The rays towards one
+ * light from one path are queued one after the other.
+ */
+class ShadowRay {
+public:
+    /* Index of the path in the queue of paths */
+    int path;
+
+    Ray ray;
+
+    /* The square light the ray comes from, nullptr for point lights */
+    const SquareLight *light;
+
+    /* Color of the light arriving along the ray if it is not occluded */
+    RGB light_color;
+
+    /* The sum of the path the light adds to, and the weight it adds with */
+    int sum;
+    float scale;
+
+    /* Whether this is the last ray from its light to the path */
+    bool last;
+
+    bool occluded;
+
+    ShadowRay(int path, const Ray &ray, const SquareLight *light,
+              const RGB &light_color, int sum, float scale, bool last) {
+        this->path = path;
+        this->ray = ray;
+        this->light = light;
+        this->light_color = light_color;
+        this->sum = sum;
+        this->scale = scale;
+        this->last = last;
+        this->occluded = false;
+    };
+};
+
+/**
+ * The materials of a scene as a structure of arrays, for the deferred
+ * shading pass. The entry after the scene's materials is the one back faces
+ * are shaded with by Material::phongShading.
+ */
+class MaterialTable {
+public:
+    std::vector<float> diffuse_r, diffuse_g, diffuse_b;
+    std::vector<float> specular_r, specular_g, specular_b;
+    std::vector<float> phong;
+    std::vector<bool> has_specular;
+
+    MaterialTable(const std::vector<Material> &materials) {
+        for (const Material &material : materials)
+            add(material.diffuse, material.specular, material.phong,
+                !material.specular_free);
+
+        add(RGB(1, 1, 0), RGB(0, 0, 0), 1, false);
+    };
+
+    void add(const RGB &diffuse, const RGB &specular, float phong,
+             bool has_specular) {
+        this->diffuse_r.push_back(diffuse.r);
+        this->diffuse_g.push_back(diffuse.g);
+        this->diffuse_b.push_back(diffuse.b);
+        this->specular_r.push_back(specular.r);
+        this->specular_g.push_back(specular.g);
+        this->specular_b.push_back(specular.b);
+        this->phong.push_back(phong);
+        this->has_specular.push_back(has_specular);
+    };
+
+    /* Index of the entry back faces are shaded with */
+    int backFace() const {
+        return (int) phong.size() - 1;
+    };
+};
+
+/**
+ * What the deferred shading pass needs to know of the hit of each path: its
+ * position, its normal (facing the viewer), the vector to the viewer and
+ * the MaterialTable entry it is shaded with (-1 without a hit), kept as a
+ * structure of arrays.
+ */
+class GBuffer {
+public:
+    std::vector<float> px, py, pz;
+    std::vector<float> nx, ny, nz;
+    std::vector<float> vx, vy, vz;
+    std::vector<int> material;
+
+    void resize(size_t size) {
+        px.resize(size);
+        py.resize(size);
+        pz.resize(size);
+        nx.resize(size);
+        ny.resize(size);
+        nz.resize(size);
+        vx.resize(size);
+        vy.resize(size);
+        vz.resize(size);
+        material.resize(size);
+    };
+};
+
+/*
+ * Number of shadow rays the deferred shading pass takes at once, few enough
+ * for their arrays to stay in the L1 cache.
+ */
+static const int SHADING_CHUNK_SIZE = 256;
+
+/**
+ * A chunk of the unoccluded shadow rays of the queue as a structure of
+ * arrays, joined with the G-buffer entries of their paths, and the light
+ * each of them brings to the hits of the queue.
+ */
+class LightSamples {
+public:
+    /* Vector from the hit to the origin of the shadow ray */
+    float dx[SHADING_CHUNK_SIZE], dy[SHADING_CHUNK_SIZE];
+    float dz[SHADING_CHUNK_SIZE];
+
+    /* Normal at the hit, and the unit vector from it to the light */
+    float nx[SHADING_CHUNK_SIZE], ny[SHADING_CHUNK_SIZE];
+    float nz[SHADING_CHUNK_SIZE];
+    float ix[SHADING_CHUNK_SIZE], iy[SHADING_CHUNK_SIZE];
+    float iz[SHADING_CHUNK_SIZE];
+
+    /* Sum of the unit vectors to the viewer and to the light */
+    float hx[SHADING_CHUNK_SIZE], hy[SHADING_CHUNK_SIZE];
+    float hz[SHADING_CHUNK_SIZE];
+
+    /* Color of the light arriving at the hit */
+    float light_r[SHADING_CHUNK_SIZE], light_g[SHADING_CHUNK_SIZE];
+    float light_b[SHADING_CHUNK_SIZE];
+
+    /* The material at the hit, and its MaterialTable entry */
+    int material[SHADING_CHUNK_SIZE];
+    float diffuse_r[SHADING_CHUNK_SIZE], diffuse_g[SHADING_CHUNK_SIZE];
+    float diffuse_b[SHADING_CHUNK_SIZE];
+    float specular_r[SHADING_CHUNK_SIZE], specular_g[SHADING_CHUNK_SIZE];
+    float specular_b[SHADING_CHUNK_SIZE];
+    float phong[SHADING_CHUNK_SIZE];
+    int has_specular[SHADING_CHUNK_SIZE];
+
+    /* Factors of the Phong model */
+    float d2[SHADING_CHUNK_SIZE], diffuse[SHADING_CHUNK_SIZE];
+    float specular[SHADING_CHUNK_SIZE];
+
+    /* Light brought by the shadow rays of the chunk */
+    float r[SHADING_CHUNK_SIZE], g[SHADING_CHUNK_SIZE];
+    float b[SHADING_CHUNK_SIZE];
+
+    /* Light brought by every unoccluded shadow ray of the queue, in order */
+    std::vector<RGB> shades;
+};
+
+/**
+ * The queues handed from one stage of the wavefront renderer to the next.
+ */
+class WavefrontQueues {
+public:
+    /* Paths being extended at the current depth */
+    std::vector<PathState> paths;
+
+    /* Paths reflected off their hit, to be extended at the next depth */
+    std::vector<PathState> reflected;
+
+    std::vector<ShadowRay> shadow_rays;
+
+    /* For deferred shading, the G-buffer of the paths and their lights */
+    GBuffer gbuffer;
+    LightSamples light_samples;
+
+    /* Shade gathered along each primary sample of the tile */
+    std::vector<RGB> shades;
+
+    /* Scratch space for the lights influencing a point */
+    std::vector<int> nearby;
+
+    /* Scratch space for sorting paths: their keys and indices */
+    std::vector<std::pair<unsigned int, int> > keys;
+};
+
+/**
+ * Counters of the tiles and of the closest hit searches, to measure how
+ * coherent the rays are.
+ */
+class WavefrontStats {
+public:
+    long tiles, tiles_missed;
+
+    /* Sum of the depths of the BVHTree nodes the tiles entered at */
+    long entry_depth;
+
+    long primary_rays;
+
+    /* BVHTree nodes visited by the searches for primary rays */
+    long primary_nodes_visited;
+
+    /* Processor time spent in the searches for primary rays */
+    clock_t primary_time;
+
+    long reflected_rays;
+
+    /* BVHTree nodes visited by the searches for reflected rays */
+    long nodes_visited;
+
+    /* Processor time spent in the searches for reflected rays */
+    clock_t time;
+
+    /* Primitives in the visibility buffer, and the threads rasterizing it */
+    long raster_primitives;
+    int raster_threads;
+
+    /* Time taken to rasterize the visibility buffer, in seconds */
+    double raster_time;
+
+    /* Primary rays that missed the primitive rasterized at their sample */
+    long raster_traced;
+
+    WavefrontStats() {
+        this->tiles = 0;
+        this->tiles_missed = 0;
+        this->entry_depth = 0;
+        this->primary_rays = 0;
+        this->primary_nodes_visited = 0;
+        this->primary_time = 0;
+        this->reflected_rays = 0;
+        this->nodes_visited = 0;
+        this->time = 0;
+        this->raster_primitives = 0;
+        this->raster_threads = 0;
+        this->raster_time = 0;
+        this->raster_traced = 0;
+    };
+};
+
+#endif //RAYTRA_WAVEFRONT_H
@@ -4,6 +4,7 @@
 #include <ImfRgba.h>
 #include <ImfRgbaFile.h>
 #include "include/Parser.h"
+#include "include/Kernels.h"
 
 using namespace Imf;
 using namespace std;
@@ -27,71 +28,199 @@ void writeRgba(const char fileName[], const Rgba *pixels,
 
 void cleanMemory(Camera *cam,
                  vector<Surface *> &surfaces,
-                 vector<Material *> &materials,
                  vector<PointLight *> &plights,
                  vector<SquareLight *> &slights) {
     delete cam;
     for (auto *surface : surfaces) delete surface;
-    for (auto *material : materials) delete material;
     for (auto *light : plights) delete light;
     for (auto *light : slights) delete light;
 }
 
+/**
+ * @name    parseOptions
+ * @brief   Reads the optional trailing command line arguments: the run mode
+ *          followed by any number of flags.
+ *
+ * @returns false if an argument could not be understood.
+ */
+bool parseOptions(int argc, char **argv, RenderOptions &options) {
+    int i = 5;
+
+    if (i < argc && argv[i][0] != '-') {
+        options.mode = atoi(argv[i++]);
+        if (options.mode != 0 && options.mode != 1) {
+            cerr << "error: incorrect mode of operation" << endl;
+            return false;
+        }
+    }
+
+    for (; i < argc; i++) {
+        string flag = argv[i];
+
+        if (flag == "-lod" && i + 1 < argc) {
+            options.lod_threshold = (float) atof(argv[++i]);
+        } else if (flag == "-light-samples" && i + 1 < argc) {
+            options.light_samples = atoi(argv[++i]);
+
+            if (options.light_samples < 0) {
+                cerr << "error: -light-samples must be >= 0 (0 turns it off)"
+                     << endl;
+                return false;
+            }
+        } else if (flag == "-adaptive-shadows") {
+            options.adaptive_shadows = true;
+        } else if (flag == "-light-cutoff" && i + 1 < argc) {
+            options.light_cutoff = (float) atof(argv[++i]);
+        } else if (flag == "-aa" && i + 3 < argc) {
+            options.aa_min_samples = atoi(argv[++i]);
+            options.aa_max_samples = atoi(argv[++i]);
+            options.aa_tolerance = (float) atof(argv[++i]);
+
+            if (options.aa_min_samples < 1 ||
+                options.aa_max_samples < options.aa_min_samples ||
+                options.aa_tolerance < 0) {
+                cerr << "error: incorrect adaptive sampling settings" << endl;
+                return false;
+            }
+        } else if (flag == "-sampler" && i + 1 < argc) {
+            options.sampler = Sampler::get(argv[++i]);
+
+            if (options.sampler == nullptr) {
+                cerr << "error: unknown sampler " << argv[i] << endl;
+                return false;
+            }
+        } else if (flag == "-samples" && i + 2 < argc) {
+            options.p_samples = atoi(argv[++i]);
+            options.s_samples = atoi(argv[++i]);
+
+            if (options.p_samples < 1 || options.s_samples < 1) {
+                cerr << "error: too less number of samples" << endl;
+                return false;
+            }
+        } else if (flag == "-shadow-budget" && i + 1 < argc) {
+            options.shadow_budget = atoi(argv[++i]);
+
+            if (options.shadow_budget < 0) {
+                cerr << "error: -shadow-budget must be >= 0 (0 turns it off)"
+                     << endl;
+                return false;
+            }
+        } else if (flag == "-depth" && i + 1 < argc) {
+            options.max_depth = atoi(argv[++i]);
+
+            if (options.max_depth < 1) {
+                cerr << "error: -depth must be >= 1" << endl;
+                return false;
+            }
+        } else if (flag == "-throughput" && i + 1 < argc) {
+            options.throughput_epsilon = (float) atof(argv[++i]);
+
+            if (options.throughput_epsilon < 0) {
+                cerr << "error: -throughput must be >= 0" << endl;
+                return false;
+            }
+        } else if (flag == "-roulette" && i + 1 < argc) {
+            options.roulette = (float) atof(argv[++i]);
+
+            if (options.roulette < 0 || options.roulette > 1) {
+                cerr << "error: -roulette must be within [0, 1]" << endl;
+                return false;
+            }
+        } else if (flag == "-wavefront") {
+            options.wavefront = true;
+        } else if (flag == "-sort-rays") {
+            /* Rays can only be sorted once they are queued */
+            options.wavefront = true;
+            options.sort_rays = true;
+        } else if (flag == "-packets") {
+            options.wavefront = true;
+            options.packets = true;
+        } else if (flag == "-raster") {
+            options.wavefront = true;
+            options.raster = true;
+        } else if (flag == "-deferred") {
+            options.wavefront = true;
+            options.deferred = true;
+        } else if (flag == "-fast-pow") {
+            options.fast_pow = true;
+        } else if (flag == "-isa" && i + 1 < argc) {
+            const Kernels *kernels = Kernels::get(argv[++i]);
+
+            if (kernels == nullptr) {
+                cerr << "error: unknown or unsupported instruction set "
+                     << argv[i] << endl;
+                return false;
+            }
+            Kernels::active = kernels;
+        } else {
+            cerr << "error: unknown option " << flag << endl;
+            return false;
+        }
+    }
+
+    /* The wavefront renderer takes a fixed number of samples everywhere */
+    if (options.wavefront &&
+        (options.aa_max_samples > 0 || options.adaptive_shadows)) {
+        cerr << "error: -wavefront does not support adaptive sampling" << endl;
+        return false;
+    }
+    return true;
+}
+
 int main(int argc, char **argv) {
 
     if (argc < 5) {
         cerr << "usage: raytra scenefilename outputfilename.exr "
-                "<primary_samples> <shadow_samples>" << endl;
+                "<primary_samples> <shadow_samples> [mode] [options]" << endl;
         return -1;
     }
 
+    RenderOptions options;
+
+    int primary_samples = atoi(argv[3]);
+    int shadow_samples = atoi(argv[4]);
+
+    if (primary_samples < 1) {
+        cerr << "error: too less number of primary samples" << endl;
+        return -1;
+    }
+
+    if (shadow_samples < 1) {
+        cerr << "error: too less number of shadow samples" << endl;
+        return -1;
+    }
+
+    /* Samples are given along each axis of the pixel / area light */
+    options.p_samples = primary_samples * primary_samples;
+    options.s_samples = shadow_samples * shadow_samples;
+
+    if (!parseOptions(argc, argv, options))
+        return -1;
+
     Camera *cam = new Camera();
     vector<Surface *> surfaces;
-    vector<Material *> materials;
+    vector<Material> materials;
     vector<PointLight *> plights;
     vector<SquareLight *> slights;
     AmbientLight ambient;
 
     parseSceneFile(argv[1], surfaces, materials, plights, slights,
-                   ambient, cam);
+                   ambient, cam, options);
 
     cout << "Surfaces: " << surfaces.size() << endl;
     cout << "Materials: " << materials.size() - 1 << endl;
-    cout << "Lights: " << slights.size() + plights.size() + 1 << endl << endl;
+    cout << "Lights: " << slights.size() + plights.size() + 1 << endl;
+    cout << "Kernels: " << Kernels::active->name << endl << endl;
 
     Array2D <Rgba> pixels;
 
-    int primary_samples = atoi(argv[3]);
-    int shadow_samples = atoi(argv[4]);
-
-    if (primary_samples < 1 || primary_samples > 100) {
-        cerr << "error: too less/many number of primary samples" << endl;
-        return -1;
-    }
-
-    if (shadow_samples < 1 || shadow_samples > 100) {
-        cerr << "error: too less/many number of shadow samples" << endl;
-        return -1;
-    }
-
-    int mode = -1;
-
-    if (argc == 6) {
-        mode = atoi(argv[5]);
-        if (mode != 0 && mode != 1) {
-            cerr << "error: incorrect mode of operation" << endl;
-            return -1;
-        }
-    }
-
     srand(1);
 
-    // TODO: add mode info -- for now defaulting to mode = -1
-    cam->render(pixels, surfaces, materials, plights, slights, ambient, mode,
-                primary_samples, shadow_samples);
+    cam->render(pixels, surfaces, materials, plights, slights, ambient,
+                options);
 
     writeRgba(argv[2], &pixels[0][0], cam->pw, cam->ph);
 
-    cleanMemory(cam, surfaces, materials, plights, slights);
+    cleanMemory(cam, surfaces, plights, slights);
     return 0;
 }
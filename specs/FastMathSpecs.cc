@@ -0,0 +1,34 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#include <cmath>
+#include "lib/catch.hpp"
+#include "../include/FastMath.h"
+
+TEST_CASE("Fast log2 and exp2 of exact powers of two", "[fast_log_exp]") {
+    REQUIRE(fastLog2(1) == 0);
+    REQUIRE(fastLog2(8) == 3);
+    REQUIRE(fastLog2(0.25f) == -2);
+    REQUIRE(fastExp2(0) == Approx(1));
+    REQUIRE(fastExp2(-3) == Approx(0.125f));
+
+    /* Underflows to 0 instead of going subnormal */
+    REQUIRE(fastExp2(-130) == 0);
+}
+
+TEST_CASE("Fast pow stays close to powf over Phong highlights",
+          "[fast_pow]") {
+    float exponents[4] = {1, 5, 32, 100};
+
+    for (float p : exponents) {
+        for (int i = 1; i <= 1000; i++) {
+            float x = i / 1000.0f;
+            REQUIRE(fastPow(x, p) == Approx(powf(x, p)).epsilon(1e-4));
+        }
+    }
+
+    REQUIRE(fastPow(1, 20) == Approx(1));
+    REQUIRE(fastPow(0, 20) == 0);
+    REQUIRE(fastPow(-0.5f, 20) == 0);
+}
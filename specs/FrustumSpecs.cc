@@ -0,0 +1,26 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#include "lib/catch.hpp"
+#include "../include/Frustum.h"
+
+TEST_CASE("Culling boxes outside a frustum open past its base",
+          "[frustum_misses]") {
+    Point corners[4] = {Point(-1, -1, -1), Point(1, -1, -1),
+                        Point(1, 1, -1), Point(-1, 1, -1)};
+    Frustum capped(Point(0, 0, 0), corners, true);
+    Frustum open(Point(0, 0, 0), corners, false);
+
+    /* Beyond the base */
+    BoundingBox far(-1, 1, -1, 1, -20, -10);
+    REQUIRE(capped.misses(far));
+    REQUIRE_FALSE(open.misses(far));
+
+    /* Beside the frustum, or behind its apex */
+    REQUIRE(open.misses(BoundingBox(15, 16, -1, 1, -11, -10)));
+    REQUIRE(open.misses(BoundingBox(-1, 1, -1, 1, 10, 20)));
+
+    /* An unbounded frustum culls nothing */
+    REQUIRE_FALSE(Frustum().misses(BoundingBox(15, 16, -1, 1, 10, 20)));
+}
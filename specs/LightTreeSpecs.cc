@@ -0,0 +1,73 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#include <cstdlib>
+#include <math.h>
+#include <vector>
+#include "lib/catch.hpp"
+#include "../include/LightTree.h"
+
+using namespace std;
+
+TEST_CASE("Lights are picked as often as their pdf says",
+          "[lighttree_sample]") {
+    vector<PointLight *> plights;
+    vector<SquareLight *> slights;
+
+    plights.push_back(new PointLight(0, 5, 0, 1, 1, 1, 1));
+    plights.push_back(new PointLight(2, 5, 1, 0.5f, 0.5f, 0.5f, 1));
+    plights.push_back(new PointLight(-4, 3, 2, 1, 0.2f, 0.2f, 1));
+    plights.push_back(new PointLight(8, 1, -3, 2, 2, 2, 1));
+    plights.push_back(new PointLight(-1, 9, -6, 0.3f, 0.3f, 1, 1));
+    plights.push_back(new PointLight(5, 4, 5, 1, 1, 0.5f, 1));
+
+    LightTree tree(plights, slights);
+    REQUIRE(tree.size() == 6);
+
+    const int N_SAMPLES = 200000;
+    Point p(1, 0, 1);
+    vector<int> picks(tree.size(), 0);
+    vector<float> pdfs(tree.size(), 0);
+
+    srand(1);
+    for (int s = 0; s < N_SAMPLES; s++) {
+        float pdf;
+        int light_idx = tree.sample(p, pdf);
+
+        REQUIRE(light_idx >= 0);
+        REQUIRE(light_idx < tree.size());
+        REQUIRE(pdf > 0);
+
+        /* A light always comes with the same pdf at the same point */
+        if (picks[light_idx] > 0)
+            REQUIRE(pdf == pdfs[light_idx]);
+
+        picks[light_idx]++;
+        pdfs[light_idx] = pdf;
+    }
+
+    float total = 0;
+    for (int l = 0; l < tree.size(); l++) {
+        REQUIRE(picks[l] > 0);
+
+        /* Well over four standard deviations of the pick frequency */
+        REQUIRE(fabsf((float) picks[l] / N_SAMPLES - pdfs[l]) < 0.005f);
+        total += pdfs[l];
+    }
+
+    REQUIRE(total == Approx(1).epsilon(1e-5));
+
+    for (PointLight *light : plights)
+        delete light;
+}
+
+TEST_CASE("A tree without lights picks none", "[lighttree_empty]") {
+    vector<PointLight *> plights;
+    vector<SquareLight *> slights;
+    LightTree tree(plights, slights);
+
+    float pdf;
+    REQUIRE(tree.size() == 0);
+    REQUIRE(tree.sample(Point(), pdf) == -1);
+}
@@ -0,0 +1,108 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#include <vector>
+#include "lib/catch.hpp"
+#include "../include/Mesh.h"
+
+using namespace std;
+
+/* Normal of the i-th triangle of a mesh, scaled by twice its area */
+static Vector normalOf(const vector<int> &tris, const vector<float> &verts,
+                       int i) {
+    Point p[3];
+
+    for (int k = 0; k < 3; k++) {
+        int v = tris[3 * i + k];
+        p[k] = Point(verts[3 * v], verts[3 * v + 1], verts[3 * v + 2]);
+    }
+
+    return p[1].sub(p[0]).cross(p[2].sub(p[0]));
+}
+
+TEST_CASE("Decimation keeps triangles that stay apart as they are",
+          "[mesh_decimate]") {
+    /* Two triangles, each corner in a cell of its own */
+    float v[] = {0, 0, 0, 4, 0, 0, 0, 4, 0,
+                 0, 0, 8, 0, 4, 8, 4, 0, 8};
+    vector<float> verts(v, v + 18), out_verts;
+    int t[] = {0, 1, 2, 3, 4, 5};
+    vector<int> tris(t, t + 6), out_tris;
+
+    Mesh::decimate(tris, verts, 1, out_tris, out_verts);
+
+    REQUIRE(out_tris.size() == 6);
+    REQUIRE(out_verts.size() == 18);
+
+    /* Same corners in the same order, so the winding is kept */
+    for (int i = 0; i < 2; i++) {
+        REQUIRE(normalOf(out_tris, out_verts, i).norm()
+                        .dot(normalOf(tris, verts, i).norm()) == Approx(1));
+    }
+}
+
+TEST_CASE("Decimation collapses vertices and drops degenerate triangles",
+          "[mesh_decimate]") {
+    /* Vertices 0 and 1 share a cell, so the first triangle loses an edge */
+    float v[] = {0, 0, 0, 0.5f, 0.5f, 0, 4, 0, 0, 0, 4, 0};
+    vector<float> verts(v, v + 12), out_verts;
+    int t[] = {0, 1, 2, 0, 2, 3};
+    vector<int> tris(t, t + 6), out_tris;
+
+    Mesh::decimate(tris, verts, 1, out_tris, out_verts);
+
+    /* The shared cell holds the mean of its vertices */
+    REQUIRE(out_verts.size() == 9);
+    REQUIRE(out_verts[0] == Approx(0.25f));
+    REQUIRE(out_verts[1] == Approx(0.25f));
+
+    REQUIRE(out_tris.size() == 3);
+    REQUIRE(normalOf(out_tris, out_verts, 0).dot(Vector(0, 0, 1)) > 0);
+}
+
+TEST_CASE("Decimation drops duplicates and sheets wound both ways",
+          "[mesh_decimate]") {
+    /* Vertex 3 shares the cell of vertex 0 */
+    float v[] = {0, 0, 0, 4, 0, 0, 0, 4, 0, 0.5f, 0.5f, 0};
+    vector<float> verts(v, v + 12), out_verts;
+    vector<int> out_tris;
+
+    /* Both triangles collapse onto the same cells with the same winding */
+    int same[] = {0, 1, 2, 3, 1, 2};
+    Mesh::decimate(vector<int>(same, same + 6), verts, 1,
+                   out_tris, out_verts);
+    REQUIRE(out_tris.size() == 3);
+
+    /*
+     * Wound against each other they are the two sides of a sheet, either of
+     * which shows its back face from the other side.
+     */
+    int sheet[] = {0, 1, 2, 3, 2, 1};
+    Mesh::decimate(vector<int>(sheet, sheet + 6), verts, 1,
+                   out_tris, out_verts);
+    REQUIRE(out_tris.empty());
+}
+
+TEST_CASE("Decimation drops triangles it turns over", "[mesh_decimate]") {
+    /*
+     * Vertices 3 and 4 pull the clusters of vertices 0 and 1 above
+     * vertex 2, which turns the triangle over.
+     */
+    float v[] = {0, 0.5f, 0, 2, 0.5f, 0, 1, 0.6f, 0,
+                 0.2f, 0.95f, 0, 2.2f, 0.95f, 0};
+    vector<float> verts(v, v + 15), out_verts;
+    int t[] = {0, 1, 2};
+    vector<int> tris(t, t + 3), out_tris;
+
+    REQUIRE(normalOf(tris, verts, 0).dot(Vector(0, 0, 1)) > 0);
+
+    Mesh::decimate(tris, verts, 1, out_tris, out_verts);
+
+    REQUIRE(out_verts.size() == 9);
+    REQUIRE(out_tris.empty());
+
+    /* Without the vertices pulling them the triangle survives */
+    Mesh::decimate(tris, vector<float>(v, v + 9), 1, out_tris, out_verts);
+    REQUIRE(out_tris.size() == 3);
+}
@@ -29,6 +29,14 @@ TEST_CASE("Moving a Point along a Vector", "[point_moveAlong]") {
     REQUIRE(p2.x == 15);
     REQUIRE(p2.y == 46);
     REQUIRE(p2.z == 10);
+
+    p1 = Point(1, 2, 3);
+    v = Vector(0.3f, -1, 2);
+    p2 = p1.moveAlong(v, 1.7f);
+
+    /* The same to the bit as moving along the scaled Vector */
+    REQUIRE(p2.sub(p1.moveAlong(v.times(1.7f))).equals(Vector(0, 0, 0)));
+    REQUIRE(p2.y == Approx(0.3f));
 }
 
 TEST_CASE("Distance-squared between two points", "[point_distance2]") {
@@ -0,0 +1,49 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#include "lib/catch.hpp"
+#include "../include/Quad.h"
+
+TEST_CASE("Quad Normal", "[quad_normal]") {
+    Quad quad(0, 0, 0, 10, 0, 0, 0, 5, 0);
+
+    REQUIRE(quad.getSurfaceNormal(Point()).dot(Vector(0, 0, 1)) == 1);
+}
+
+TEST_CASE("Intersection of Ray with Quad", "[quad_intersects]") {
+    Quad quad(0, 0, 0, 10, 0, 0, 2, 5, 0);
+    Hit hit;
+
+    Ray ray(Point(11, 4, 10), Vector(0, 0, -1));
+    REQUIRE(quad.getIntersection(ray, hit) == 10);
+    REQUIRE(hit.u == Approx(0.94));
+    REQUIRE(hit.v == Approx(0.8));
+
+    ray = Ray(Point(1, 4, 10), Vector(0, 0, -1));
+    REQUIRE(quad.getIntersection(ray) == -1);
+
+    ray = Ray(Point(5, 2, 10), Vector(0, 0, 1));
+    REQUIRE(quad.getIntersection(ray) == -1);
+}
+
+TEST_CASE("Culling the back face of a Quad", "[quad_cull]") {
+    Quad quad(0, 0, 0, 10, 0, 0, 2, 5, 0);
+    Ray front(Point(5, 2, 10), Vector(0, 0, -1));
+    Ray back(Point(5, 2, -10), Vector(0, 0, 1));
+
+    REQUIRE(quad.getIntersection(back) == 10);
+
+    quad.cullBackFaces = true;
+    REQUIRE(quad.getIntersection(back) == -1);
+    REQUIRE(quad.getIntersection(front) == 10);
+}
+
+TEST_CASE("BoundingBox for Quads", "[quad_bbox]") {
+    Quad quad(0, 0, 0, 10, 0, 0, 2, 5, 0);
+
+    REQUIRE(quad.bbox->x_min == 0);
+    REQUIRE(quad.bbox->x_max == 12);
+    REQUIRE(quad.bbox->y_min == 0);
+    REQUIRE(quad.bbox->y_max == 5);
+}
@@ -0,0 +1,120 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#include "lib/catch.hpp"
+#include "../include/RayPacket.h"
+#include "../include/Kernels.h"
+
+TEST_CASE("Slab testing a box against a packet of rays",
+          "[raypacket_intersectBox]") {
+    RayPacket packet;
+    BoundingBox box(-1, 1, -1, 1, -1, 1);
+
+    for (int r = 0; r < 8; r++) {
+        Point origin(-4 + r, 0.5f, 10);
+        Ray ray(origin, Point(-4 + r, 0.5f, 0).sub(origin).norm());
+        ray.t_max = 10;
+        packet.add(ray);
+    }
+
+    unsigned int mask = packet.intersectBox(box, packet.activeMask());
+
+    /* Every ray gets the outcome of its own slab test */
+    for (int r = 0; r < packet.size; r++) {
+        bool hit = box.getIntersection(packet.rays[r]) != -1;
+        REQUIRE(((mask >> r) & 1u) == (unsigned int) hit);
+    }
+
+    REQUIRE(mask == 0x38);
+    REQUIRE(packet.intersectBox(box, 0x8) == 0x8);
+}
+
+TEST_CASE("Slab testing with every set of kernels the processor supports",
+          "[raypacket_kernels]") {
+    const Kernels *active = Kernels::active;
+    RayPacket packet;
+    BoundingBox box(-1, 1, -1, 1, -1, 1);
+
+    for (int r = 0; r < RAY_PACKET_SIZE; r++) {
+        Point origin(-4 + r * 0.5f, 0.5f - r % 3, 10 - r % 4);
+        Ray ray(origin, Point(0, 0, 0).sub(origin).norm());
+        ray.t_max = 10;
+        packet.add(ray);
+    }
+
+    float expected[RAY_PACKET_SIZE], t_hits[RAY_PACKET_SIZE];
+
+    Kernels::active = Kernels::get("generic");
+    unsigned int mask = packet.intersectBox(box, packet.activeMask(),
+                                            expected);
+
+    const char *names[] = {"avx2", "avx512"};
+    for (const char *name : names) {
+        Kernels::active = Kernels::get(name);
+        if (Kernels::active == nullptr)
+            continue;
+
+        REQUIRE(packet.intersectBox(box, packet.activeMask(), t_hits) ==
+                mask);
+
+        for (int r = 0; r < packet.size; r++)
+            if ((mask >> r) & 1u)
+                REQUIRE(t_hits[r] == expected[r]);
+    }
+
+    Kernels::active = active;
+}
+
+TEST_CASE("Culling boxes outside the frustum of a packet",
+          "[raypacket_frustumMisses]") {
+    RayPacket packet;
+    Point corners[4] = {Point(-1, -1, 10), Point(1, -1, 10),
+                        Point(1, 1, 10), Point(-1, 1, 10)};
+
+    packet.setFrustum(Point(0, 0, 0), corners);
+
+    REQUIRE_FALSE(packet.frustumMisses(BoundingBox(-0.1f, 0.1f, -0.1f, 0.1f,
+                                                   4, 5)));
+    REQUIRE_FALSE(packet.frustumMisses(BoundingBox(-5, 5, -5, 5, 4, 5)));
+
+    /* Within the bounds of the frustum but outside its side planes */
+    REQUIRE(packet.frustumMisses(BoundingBox(0.8f, 1, 0.8f, 1, 1, 2)));
+
+    /* Outside the bounds of the frustum */
+    REQUIRE(packet.frustumMisses(BoundingBox(-1, 1, -1, 1, 11, 12)));
+}
+
+TEST_CASE("Culling boxes missed by a packet of rays from one origin",
+          "[raypacket_intervalMisses]") {
+    RayPacket packet;
+
+    for (int r = 0; r < 4; r++) {
+        Point target(0.1f * r, 0.1f * (r % 2), -10);
+        packet.add(Ray(Point(0, 0, 0), target.sub(Point(0, 0, 0)).norm()));
+    }
+
+    REQUIRE_FALSE(packet.intervalMisses(BoundingBox(-1, 1, -1, 1, -6, -5),
+                                        INFINITY));
+    REQUIRE(packet.intervalMisses(BoundingBox(2, 3, -1, 1, -6, -5),
+                                  INFINITY));
+
+    /* Behind the origin, or beyond the closest hits so far */
+    REQUIRE(packet.intervalMisses(BoundingBox(-1, 1, -1, 1, 5, 6),
+                                  INFINITY));
+    REQUIRE(packet.intervalMisses(BoundingBox(-1, 1, -1, 1, -6, -5), 4));
+
+    /* Every ray gets the outcome of its own slab test */
+    BoundingBox box(0.04f, 0.07f, -1, 1, -6, -5);
+    float t_hits[RAY_PACKET_SIZE];
+    unsigned int mask = packet.intersectBox(box, packet.activeMask(), t_hits);
+
+    for (int r = 0; r < packet.size; r++) {
+        float t = box.getIntersection(packet.rays[r]);
+
+        REQUIRE(((mask >> r) & 1u) == (unsigned int) (t != -1));
+        if (t != -1)
+            REQUIRE(t_hits[r] == t);
+    }
+    REQUIRE(mask == 0x2);
+}
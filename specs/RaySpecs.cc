@@ -3,6 +3,7 @@
 //
 
 #include "lib/catch.hpp"
+#include <limits>
 #include "../include/Ray.h"
 
 TEST_CASE("Getting a point on a Ray", "[ray_getPointOnIt]") {
@@ -33,3 +34,18 @@ TEST_CASE("Getting the offset of a Point on the ray from the origin",
 
     REQUIRE(ray2.getOffsetFromOrigin(p2) == -5);
 }
+
+TEST_CASE("Precomputed slab test data of a Ray", "[ray_inv_direction]") {
+    Ray ray(Point(0, 0, 0), Vector(0.5, -0.25, 0));
+
+    REQUIRE(ray.inv_direction.i == 2);
+    REQUIRE(ray.inv_direction.j == -4);
+    REQUIRE(ray.inv_direction.k == std::numeric_limits<float>::infinity());
+
+    REQUIRE(ray.sign[0] == 0);
+    REQUIRE(ray.sign[1] == 1);
+    REQUIRE(ray.sign[2] == 0);
+
+    REQUIRE(ray.t_min == 0);
+    REQUIRE(ray.t_max == std::numeric_limits<float>::infinity());
+}
@@ -0,0 +1,145 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#include <cstdlib>
+#include <vector>
+#include "lib/catch.hpp"
+#include "../include/Sampler.h"
+
+using namespace std;
+
+static const char *SAMPLERS[4] = {"jittered", "halton", "sobol", "cmj"};
+
+/*
+ * Requires every cell of a rows x cols grid over the unit square to hold
+ * exactly one of the count points of the set.
+ */
+static void requireOnePerCell(const Sampler *sampler, int count,
+                              unsigned int seed, int rows, int cols) {
+    vector<int> cells(rows * cols, 0);
+
+    for (int k = 0; k < count; k++) {
+        float u, v;
+        sampler->get2D(k, count, seed, u, v);
+        cells[(int) (u * rows) * cols + (int) (v * cols)]++;
+    }
+
+    for (int cell : cells)
+        REQUIRE(cell == 1);
+}
+
+TEST_CASE("Sample points lie in the unit square", "[sampler_get2D]") {
+    int counts[6] = {1, 2, 7, 16, 33, 256};
+
+    srand(1);
+    for (const char *name : SAMPLERS) {
+        const Sampler *sampler = Sampler::get(name);
+        REQUIRE(sampler != nullptr);
+
+        for (int count : counts) {
+            for (unsigned int seed = 0; seed < 20; seed++) {
+                for (int k = 0; k < count; k++) {
+                    float u, v;
+                    sampler->get2D(k, count, hashSeed(seed), u, v);
+
+                    REQUIRE(u >= 0);
+                    REQUIRE(u < 1);
+                    REQUIRE(v >= 0);
+                    REQUIRE(v < 1);
+                }
+            }
+        }
+    }
+
+    REQUIRE(Sampler::get("uniform") == nullptr);
+}
+
+TEST_CASE("Jittered and CMJ sets of a square count fill every cell once",
+          "[sampler_stratified]") {
+    int sides[4] = {1, 2, 5, 16};
+
+    srand(1);
+    for (int side : sides) {
+        for (unsigned int seed = 0; seed < 20; seed++) {
+            requireOnePerCell(Sampler::get("jittered"), side * side,
+                              hashSeed(seed), side, side);
+            requireOnePerCell(Sampler::get("cmj"), side * side,
+                              hashSeed(seed), side, side);
+        }
+    }
+
+    /* The Sobol points stratify the square for any power of two count */
+    for (unsigned int seed = 0; seed < 20; seed++) {
+        requireOnePerCell(Sampler::get("sobol"), 16, hashSeed(seed), 4, 4);
+        requireOnePerCell(Sampler::get("sobol"), 64, hashSeed(seed), 8, 8);
+        requireOnePerCell(Sampler::get("sobol"), 32, hashSeed(seed), 2, 16);
+    }
+}
+
+TEST_CASE("A seeded sample set is the same every time it is drawn",
+          "[sampler_deterministic]") {
+    /* The jittered sampler draws from rand() and ignores the seed */
+    const char *seeded[3] = {"halton", "sobol", "cmj"};
+
+    for (const char *name : seeded) {
+        const Sampler *sampler = Sampler::get(name);
+
+        for (int k = 0; k < 33; k++) {
+            float u1, v1, u2, v2, u3, v3;
+            sampler->get2D(k, 33, 42, u1, v1);
+
+            /* Drawing from another set in between changes nothing */
+            sampler->get2D(5, 7, 9, u3, v3);
+            sampler->get2D(k, 33, 42, u2, v2);
+
+            REQUIRE(u1 == u2);
+            REQUIRE(v1 == v2);
+        }
+
+        /* Different seeds scramble the set differently */
+        float u1, v1, u2, v2;
+        sampler->get2D(3, 16, hashSeed(1), u1, v1);
+        sampler->get2D(3, 16, hashSeed(2), u2, v2);
+        REQUIRE((u1 != u2 || v1 != v2));
+    }
+}
+
+TEST_CASE("Sample windows tile the shared set", "[sample_window]") {
+    int totals[5] = {1, 4, 9, 64, 100};
+    int windows[5] = {1, 3, 4, 9, 64};
+
+    for (int total : totals) {
+        for (int n : windows) {
+            vector<int> covered(total, 0);
+            int next = 0;
+
+            for (int k = 0; k < n; k++) {
+                SampleWindow window(7, k, n, total);
+
+                REQUIRE(window.seed == 7);
+                REQUIRE(window.total == total);
+                REQUIRE(window.count >= 1);
+                REQUIRE(window.first >= 0);
+                REQUIRE(window.first + window.count <= total);
+
+                /* Each window starts where the previous one ended */
+                if (total >= n)
+                    REQUIRE(window.first == next);
+                next = window.first + window.count;
+
+                for (int i = window.first; i < next; i++)
+                    covered[i]++;
+            }
+
+            REQUIRE(next == total);
+
+            /* Every point is used, each by one window if there are enough */
+            for (int times : covered) {
+                REQUIRE(times >= 1);
+                if (total >= n)
+                    REQUIRE(times == 1);
+            }
+        }
+    }
+}
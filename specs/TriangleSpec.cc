@@ -11,16 +11,46 @@ TEST_CASE("Triangle Normal", "[triangle_normal]") {
     REQUIRE(triangle.getSurfaceNormal(Point()).dot(Vector(0, 0, 1)) == 1);
 }
 
+TEST_CASE("Intersection of Ray with Triangle", "[triangle_intersects]") {
+    Triangle triangle(0, 0, 0, 10, 0, 0, 5, 5, 0);
+    Hit hit;
+
+    Ray ray(Point(5, 2, 10), Vector(0, 0, -1));
+    REQUIRE(triangle.getIntersection(ray, hit) == 10);
+    REQUIRE(hit.u == Approx(0.3));
+    REQUIRE(hit.v == Approx(0.4));
+    REQUIRE(hit.geometric_normal.equals(Vector(0, 0, 1)));
+    REQUIRE_FALSE(hit.smooth);
+
+    /* A miss leaves the hit as it was */
+    ray = Ray(Point(9, 4, 10), Vector(0, 0, -1));
+    REQUIRE(triangle.getIntersection(ray, hit) == -1);
+    REQUIRE(hit.u == Approx(0.3));
+    REQUIRE(hit.v == Approx(0.4));
+}
+
+TEST_CASE("Culling the back face of a Triangle", "[triangle_cull]") {
+    Triangle triangle(0, 0, 0, 10, 0, 0, 5, 5, 0);
+    Ray front(Point(5, 2, 10), Vector(0, 0, -1));
+    Ray back(Point(5, 2, -10), Vector(0, 0, 1));
+
+    REQUIRE(triangle.getIntersection(back) == 10);
+
+    triangle.cullBackFaces = true;
+    REQUIRE(triangle.getIntersection(back) == -1);
+    REQUIRE(triangle.getIntersection(front) == 10);
+}
+
 TEST_CASE("BoundingBox for Triangles", "[triangle_bbox]") {
     Triangle triangle (0, 0, 0, 10, 0, 0, 5, 5, 0);
-    BoundingBox bbox = triangle.getBoundingBox();
+    BoundingBox bbox = *triangle.bbox;
 
     REQUIRE(bbox.center.x == 5);
     REQUIRE(bbox.center.y == 2.5);
     REQUIRE(bbox.center.z == 0);
 
     triangle = Triangle(0, 0, 0, 10, 5, -7, 2, 20, 2);
-    bbox = triangle.getBoundingBox();
+    bbox = *triangle.bbox;
 
     REQUIRE(bbox.center.x == 5);
     REQUIRE(bbox.center.y == 10);
@@ -74,6 +74,14 @@ TEST_CASE("Cross product between two vectors", "[vector_cross_product]") {
     REQUIRE(vec3.i == 0);
     REQUIRE(vec3.j == 1);
     REQUIRE(vec3.k == 0);
+
+    vec1 = Vector(2, -3, 5);
+    vec2 = Vector(-1, 4, 7);
+    vec3 = vec1.cross(vec2);
+
+    REQUIRE(vec3.i == -41);
+    REQUIRE(vec3.j == -19);
+    REQUIRE(vec3.k == 5);
 }
 
 TEST_CASE("Addition of two vectors", "[vector_plus]") {
@@ -105,4 +113,16 @@ TEST_CASE("Invert a Vector", "[vector_invert]") {
     REQUIRE(vec2.i == -9);
     REQUIRE(vec2.j == -1);
     REQUIRE(vec2.k == 3.5);
-}
\ No newline at end of file
+}
+
+TEST_CASE("Adding a constant times a Vector", "[vector_plusTimes]") {
+    Vector vec1, vec2, vec3;
+
+    vec1 = Vector(1, -2, 0.5f);
+    vec2 = Vector(0.1f, 3, -7);
+    vec3 = vec1.plusTimes(vec2, -2.5f);
+
+    /* The same to the bit as the two steps it stands for */
+    REQUIRE(vec3.equals(vec1.plus(vec2.times(-2.5f))));
+    REQUIRE(vec3.j == -9.5f);
+}